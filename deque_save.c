@@ -1,24 +1,12 @@
 // --------------------------------------------------------------------------------------------------------------------
 // Data structure - Deque
 
-// Single bi-directional node contains customized feature
-struct BiDirectionalNode__{
-	struct BiDirectionalNode__ *prev, *next;
-	void *feature;
-}; typedef struct BiDirectionalNode__ BiDirectionalNode;
-
-// Construct new node
-BiDirectionalNode* newBiDirectionalNode(void *feature){
-	BiDirectionalNode* newNode = (BiDirectionalNode*)malloc(sizeof(BiDirectionalNode));
-	newNode->prev = NULL, newNode->next = NULL;
-	newNode->feature = feature;
-	return newNode;
-}
-
-// Whole deque
+// Whole deque. Features are kept in contiguous ring buffer, so push and pop never allocate per element.
+// i-th feature from front is buffer[(head + i) & (capacity - 1)]; capacity is always power of 2.
 struct Deque__{
-	BiDirectionalNode *front, *back; // front = back->next->...->next, back = front->prev->...->prev
-	int maxSize, currentSize;
+	void **buffer;
+	int head, capacity;
+	int maxSize, currentSize; // maxSize = 0 means unbounded
 	char* name;
 }; typedef struct Deque__ Deque;
 
@@ -28,33 +16,57 @@ Deque* newDeque(int maxsize, const char* name){
 		printf("Negative max size(%d) given in function newDeque\n", maxsize);
 		return NULL;
 	}
-	Deque *newDq = (Deque*)malloc(sizeof(Deque));
-	newDq->front = NULL, newDq->back = NULL;
-	newDq->currentSize = 0; newDq->maxSize = 0;
+	Deque *newDq = (Deque*)countedMalloc(sizeof(Deque));
+	newDq->capacity = 16;
+	while(maxsize > 0 && newDq->capacity < maxsize && newDq->capacity < 1024) newDq->capacity *= 2;
+	newDq->buffer = (void**)countedMalloc(sizeof(void*) * newDq->capacity);
+	newDq->head = 0;
+	newDq->currentSize = 0; newDq->maxSize = maxsize;
 	newDq->name = strdup(name);
 	return newDq;
 }
 
+// Check size limit and make sure there is a space for one more feature. Return false if size limit reached.
+bool reserveDeque(Deque *dq, const char *caller){
+	if(dq->maxSize != 0 && dq->currentSize >= dq->maxSize){ // Deque reached size limit; Cancel push.
+		printf("Deque <%s> size limit reached in %s\n", dq->name, caller);
+		return false;
+	}
+	if(dq->currentSize == dq->capacity){ // Unroll into doubled buffer
+		void **newBuffer = (void**)countedMalloc(sizeof(void*) * dq->capacity * 2);
+		for(int i=0; i<dq->currentSize; i++) newBuffer[i] = dq->buffer[(dq->head + i) & (dq->capacity - 1)];
+		free(dq->buffer);
+		dq->buffer = newBuffer, dq->head = 0, dq->capacity *= 2;
+	} return true;
+}
+
 // Push new feature to front of the deque. Return true if push was successful, otherwise false.
 bool pushFront(Deque *dq, void* newFeature){
-	if(dq->maxSize == 0 || dq->currentSize < dq->maxSize){ // If given dq is unbounded or have enough extra space
-		BiDirectionalNode* newNode = newBiDirectionalNode(newFeature);
-		if(dq->currentSize == 0){ // Create single
-			dq->front = newNode;
-			dq->back = newNode;
-		}
-		else{ // (front) newNode dq->front ... dq->back (back)
-			newNode->prev = dq->front;
-			dq->front->next = newNode;
-			dq->front = newNode;
-		}
-		dq->currentSize++;
-		return true;
-	}
-	else{ // Deque reached size limit; Cancel allocation.
-		printf("Deque <%s> size limit reached in pushFront\n", dq->name);
-		return false;
+	if(!reserveDeque(dq, "pushFront")) return false;
+	dq->head = (dq->head - 1) & (dq->capacity - 1);
+	dq->buffer[dq->head] = newFeature;
+	dq->currentSize++;
+	return true;
+}
+
+// Push new feature to back of the deque. Return true if push was successful, otherwise false.
+bool pushBack(Deque *dq, void* newFeature){
+	if(!reserveDeque(dq, "pushBack")) return false;
+	dq->buffer[(dq->head + dq->currentSize) & (dq->capacity - 1)] = newFeature;
+	dq->currentSize++;
+	return true;
+}
+
+// Pop front
+void* popFront(Deque *dq){
+	if(dq->currentSize == 0){
+		printf("Tried pop_front to empty Deque <%s>\n", dq->name);
+		return NULL;
 	}
+	void* poppedFeature = dq->buffer[dq->head];
+	dq->head = (dq->head + 1) & (dq->capacity - 1);
+	dq->currentSize--;
+	return poppedFeature;
 }
 
 // Pop back
@@ -63,30 +75,28 @@ void* popBack(Deque *dq){
 		printf("Tried pop_back to empty Deque <%s>\n", dq->name);
 		return NULL;
 	}
-	else{
-		BiDirectionalNode* poppedNode = dq->back;
-		void* poppedFeature = poppedNode->feature;
-		dq->back = poppedNode->next;
-		if(dq->back != NULL) dq->back->prev = NULL;
-		dq->currentSize--;
-		free(poppedNode);
-		return poppedFeature;
-	}
+	dq->currentSize--;
+	return dq->buffer[(dq->head + dq->currentSize) & (dq->capacity - 1)];
 }
 
+// Peek front and back without popping. Return NULL if empty.
+void* peekFront(Deque *dq){return dq->currentSize == 0 ? NULL : dq->buffer[dq->head];}
+void* peekBack(Deque *dq){return dq->currentSize == 0 ? NULL : dq->buffer[(dq->head + dq->currentSize - 1) & (dq->capacity - 1)];}
+
 // Clear all elements
 void clearDeque(Deque *dq, bool freeFeature){
 	while(dq->currentSize > 0){
 		void* feature = popBack(dq);
 		if(freeFeature) free(feature);
 	}
-	dq->front = NULL;
-	dq->back = NULL;
+	dq->head = 0;
 }
 
 // Delete deque itself
 void deleteDeque(Deque *dq, bool freeFeature){
 	clearDeque(dq, freeFeature);
+	free(dq->buffer);
+	free(dq->name);
 	free(dq);
 }
 
@@ -95,7 +105,7 @@ void deleteDeque(Deque *dq, bool freeFeature){
 void DequeFunctionalityTest1(){
 	Deque* dq = newDeque(100, "test deque");
 	for(int i=0; i<100; i++){
-		int *feature = (int*)malloc(sizeof(int));
+		int *feature = (int*)countedMalloc(sizeof(int));
 		*feature = superrandom(0, 1000);
 		bool status = pushFront(dq, (void*)feature);
 		if(status){
@@ -105,9 +115,39 @@ void DequeFunctionalityTest1(){
 				printf("Popping: ");
 				void *feature = popBack(dq);
 				printf("Popped %d from deque <%s>\n", *(int*)feature, dq->name);
+				free(feature);
 			}
 		}
 		else break;
 	}
 	deleteDeque(dq, true);
 }
+
+// Testing all four end operations and size limit against plain array
+void DequeFunctionalityTest2(){
+	const int maxSize = 50;
+	Deque* dq = newDeque(maxSize, "test deque 2");
+	int model[2 * maxSize + 1], front = maxSize, back = maxSize; // model[front, back) is expected content
+	bool same = true;
+	for(int i=0; i<2000; i++){
+		int operation = superrandom(0, 3), value = superrandom(0, 1000);
+		bool room = (back - front < maxSize);
+		switch(operation){
+			case 0: if(pushFront(dq, (void*)(long)value) != room) same = false;
+				if(room) model[--front] = value;
+				break;
+			case 1: if(pushBack(dq, (void*)(long)value) != room) same = false;
+				if(room) model[back++] = value;
+				break;
+			case 2: if(back > front && (long)popFront(dq) != model[front++]) same = false; break;
+			case 3: if(back > front && (long)popBack(dq) != model[--back]) same = false; break;
+		}
+		if(dq->currentSize != back - front) same = false;
+		if(front == 0 || back == 2 * maxSize + 1){ // Recenter model; Old and new ranges can overlap
+			memmove(model + maxSize / 2, model + front, (back - front) * sizeof *model);
+			back = back - front + maxSize / 2, front = maxSize / 2;
+		}
+	}
+	printf("Deque four end operations: %s\n", testVerdict(same, "Mismatch"));
+	deleteDeque(dq, false);
+}
@@ -3,16 +3,21 @@
 	
 	Description: 
 		Term project for Korea University's Operating System lecture.
+		Build: gcc -O2 main.c -o main -lm -lpthread
 		
 	Goals:
 		(o) - Creating process: ID, CPU burst, IO burst, Arrival time, Given priority 
-		(?) - Config: Ready queue, Waiting queue
+		(o) - Config: Ready queue (o), Waiting queue (o)
 		(o) - Random I/O performing
+		(o) - I/O bursts between CPU bursts, served by I/O devices with their own waiting queues
 			- Schedule (Implement both preemptive and non-preemptive)
 				(o) - First Come First Serve
 				(o) - Shortest Job First
 				(o) - Given Priority
 				(o) - Round Robin
+				(o) - Multilevel Feedback Queue
+		(o) - Multi-core scheduling: global queue, per-core queues with work stealing or affinity
+		(o) - Streaming process traces (text, binary, memory mapped)
 		(o) - Gantt chart displaying
 		(o) - Evaluation: Calculate average waiting time, turnaround time
 			- Additional features
@@ -26,8 +31,20 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
 #include <math.h>
 #include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define useX86Kernels
+#endif
 
 // --------------------------------------------------------------------------------------------------------------------
 // Constants
@@ -38,91 +55,378 @@ typedef enum {false, true} bool;
 // --------------------------------------------------------------------------------------------------------------------
 // Base functions
 
+// Functions marked as specialized are inlined into every caller, so constant arguments given by caller
+// (e.g. criteria of specialized scheduling loop) fold branches on them. See defineScheduleLoop.
+#define specialized static inline __attribute__((always_inline))
+
 // Min and Max
 int min2(int a, int b){return a<b ? a:b;}
 int max2(int a, int b){return a>b ? a:b;}
 
+// Allocation counters. Allocations go through wrappers below, so benchmark can report allocations of single run
+// if compiled with -DuseAllocCounters. Counters are atomic since runs can be done in parallel.
+#ifdef useAllocCounters
+static long long globalAllocationCount = 0, globalAllocatedBytes = 0;
+#define countAllocation(bytes) do{ \
+		__atomic_add_fetch(&globalAllocationCount, 1, __ATOMIC_RELAXED); \
+		__atomic_add_fetch(&globalAllocatedBytes, (long long)(bytes), __ATOMIC_RELAXED); \
+	} while(0)
+#else
+#define countAllocation(bytes)
+#endif
+void* countedMalloc(size_t size){countAllocation(size); return malloc(size);}
+void* countedCalloc(size_t count, size_t size){countAllocation(count * size); return calloc(count, size);}
+void* countedRealloc(void *pointer, size_t size){countAllocation(size); return realloc(pointer, size);}
+
+// Peak resident set size of this program in KiB
+long peakRSS(){
+	struct rusage usage;
+	return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+}
+
+// Wall clock seconds since given time point
+double elapsedSeconds(struct timespec *begin){
+	struct timespec now; clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - begin->tv_sec) + (now.tv_nsec - begin->tv_nsec) * 1e-9;
+}
+
 // Repeated printing.
-void printRepeat(const char *line, int count, bool everyNewline){
+void fprintRepeat(FILE *out, const char *line, int count, bool everyNewline){
 	for(int i=0; i<count; i++){
-		printf("%s", line);
-		if(everyNewline) printf("\n");
+		fprintf(out, "%s", line);
+		if(everyNewline) fprintf(out, "\n");
 	}
 }
+void printRepeat(const char *line, int count, bool everyNewline){fprintRepeat(stdout, line, count, everyNewline);}
+
+// Number of failed checks in functionality tests, so --test can exit with failure
+static int globalTestFailures = 0;
+
+// Verdict of functionality test check to print: "OK" if passed, otherwise given failure message, which is counted.
+const char* testVerdict(bool passed, const char *failure){
+	if(!passed) globalTestFailures++;
+	return passed ? "OK" : failure;
+}
 
 // --------------------------------------------------------------------------------------------------------------------
-// Random
+// Instrumentation
+
+// Hot path counters and cycle timers of single scheduling run, compiled only if useInstrumentation is defined
+// (e.g. gcc -DuseInstrumentation). Otherwise every instrument macro expands to nothing and no field is added.
+// Scheduler points instrumentCurrent at its timeline's counters while it runs, so leaf functions such as comparisons
+// don't need timeline. Single run never leaves its thread, so counters are thread local and need no atomics.
+#ifdef useInstrumentation
+typedef enum {
+	CounterComparisons, // processComparisonGT, tableComparisonGT and fair run queue comparisons
+	CounterPicks, CounterPickScanned, // Processes picked, and keys scanned or heap levels descended only while popping them
+	CounterSegmentsAppended, CounterSegmentsCoalesced, // Timeline segments written, and jobs merged into open segment
+	CounterSwitchSegments, // Context switching intervals inserted into timeline
+	CounterRequeues, // Preempted process put back to its queue, e.g. restarting its round robin cycle
+	InstrumentCounterNum
+} InstrumentCounter;
+typedef enum {TimerPick, TimerDispatch, TimerGanttChart, InstrumentTimerNum} InstrumentTimer;
+struct Instrumentation__{
+	long long counters[InstrumentCounterNum];
+	unsigned long long cycles[InstrumentTimerNum];
+}; typedef struct Instrumentation__ Instrumentation;
+static __thread Instrumentation *instrumentCurrent = NULL;
+
+// Time stamp counter on x86, nanoseconds elsewhere
+specialized unsigned long long readCycles(){
+#ifdef useX86Kernels
+	return __rdtsc();
+#else
+	struct timespec now; clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+#define instrumentAttach(instrumentation) (instrumentCurrent = (instrumentation))
+#define instrumentCount(counter, amount) do{ if(instrumentCurrent != NULL) instrumentCurrent->counters[counter] += (amount); } while(0)
+#define instrumentTimerBegin(name) unsigned long long instrumentBegin_##name = readCycles()
+#define instrumentTimerEnd(name, timer) do{ \
+		if(instrumentCurrent != NULL) instrumentCurrent->cycles[timer] += readCycles() - instrumentBegin_##name; \
+	} while(0)
+#define instrumentTimerEndInto(name, timer, instrumentation) ((instrumentation)->cycles[timer] += readCycles() - instrumentBegin_##name)
+#else
+#define instrumentAttach(instrumentation) ((void)0)
+#define instrumentCount(counter, amount) ((void)(amount)) // Amount is still evaluated, so variables kept only for counting are used
+#define instrumentTimerBegin(name)
+#define instrumentTimerEnd(name, timer) ((void)0)
+#define instrumentTimerEndInto(name, timer, instrumentation) ((void)0)
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+// Output writer
+
+// How much is written. Debug also prints scheduling decisions; Quiet writes only exported timelines.
+typedef enum {VerbosityQuiet, VerbositySummary, VerbosityNormal, VerbosityDebug} Verbosity;
+
+// Format of timeline output. Text is Gantt chart, others are exports (see Timeline export).
+typedef enum {TimelineFormatText, TimelineFormatBinary, TimelineFormatCSV, TimelineFormatJSON} TimelineFormat;
+const char *TimelineFormatNames[4] = {"text", "binary", "csv", "json"};
+
+// Buffered writer over FILE. Pieces are formatted into single large buffer which is written by one fwrite
+// whenever it gets full, so writing many small pieces doesn't go through stdio each time.
+#define outputWriterBufferSize (1<<16)
+#define outputWriterMaxPiece 1024 // Longest piece writerPrintf can format
+struct OutputWriter__{
+	FILE *file;
+	char *buffer;
+	int size;
+}; typedef struct OutputWriter__ OutputWriter;
+
+// Create new one
+OutputWriter* newOutputWriter(FILE *file){
+	OutputWriter *newWriter = (OutputWriter*)countedMalloc(sizeof(OutputWriter));
+	newWriter->file = file;
+	newWriter->buffer = (char*)countedMalloc(outputWriterBufferSize);
+	newWriter->size = 0;
+	return newWriter;
+}
+
+// Write buffered pieces into file
+void writerFlush(OutputWriter *writer){
+	if(writer->size > 0) fwrite(writer->buffer, 1, writer->size, writer->file);
+	writer->size = 0;
+}
+
+// Flush and delete writer itself. File is not closed.
+void deleteOutputWriter(OutputWriter *writer){
+	writerFlush(writer);
+	free(writer->buffer);
+	free(writer);
+}
+
+// Make sure there is a space for given length
+void writerReserve(OutputWriter *writer, int length){
+	if(writer->size + length > outputWriterBufferSize) writerFlush(writer);
+}
 
-// Seed
-const unsigned int seedRefreshInterval = 10, callThreshold = 1<<16;
-unsigned int lastSetSeed = -1, called = 0;
-void setSeed(){
-	unsigned int currentTime = (unsigned int)time(NULL);
-	if(currentTime - lastSetSeed >= seedRefreshInterval){
-		srand(currentTime);
-		lastSetSeed = currentTime;
-		called = 0;
+void writerPutChar(OutputWriter *writer, char c){
+	writerReserve(writer, 1);
+	writer->buffer[writer->size++] = c;
+}
+void writerPutBytes(OutputWriter *writer, const void *bytes, int length){
+	if(length > outputWriterBufferSize){ // Too long to buffer
+		writerFlush(writer);
+		fwrite(bytes, 1, length, writer->file);
+		return;
 	}
+	writerReserve(writer, length);
+	memcpy(writer->buffer + writer->size, bytes, length);
+	writer->size += length;
 }
+void writerPutString(OutputWriter *writer, const char *str){writerPutBytes(writer, str, (int)strlen(str));}
+void writerPutRepeat(OutputWriter *writer, char c, int count){for(int i=0; i<count; i++) writerPutChar(writer, c);}
 
-// Redeclare random [0 ~ RAND_MAX] with advanced features
-int myRandom(){
-	called++;
-	if(lastSetSeed == -1 || callThreshold <= called) setSeed();
-	return rand() % (1<<15);
+// Same as printf("%*d") with given width, or printf("%0*d") if pad is '0'.
+void writerPutInt(OutputWriter *writer, int value, int width, char pad){
+	char digits[16]; int length = 0;
+	unsigned int magnitude = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+	do{ digits[length++] = (char)('0' + magnitude % 10); magnitude /= 10; } while(magnitude > 0);
+	int total = length + (value < 0);
+	writerReserve(writer, max2(width, total));
+	if(pad == '0' && value < 0) writer->buffer[writer->size++] = '-';
+	for(int i=total; i<width; i++) writer->buffer[writer->size++] = pad;
+	if(pad != '0' && value < 0) writer->buffer[writer->size++] = '-';
+	while(length > 0) writer->buffer[writer->size++] = digits[--length];
 }
 
-// Uniform number has $bits bits 
-int randomBits(bool positiveOnly){
-	int val = (myRandom() << 15) + myRandom();
-	val ^= (myRandom() & (positiveOnly ? 1:3)) << 30;
-	return val;
+// Unsigned LEB128 varint
+void writerPutVarint(OutputWriter *writer, unsigned long long value){
+	writerReserve(writer, 10);
+	while(value >= 0x80){
+		writer->buffer[writer->size++] = (char)(value | 0x80);
+		value >>= 7;
+	} writer->buffer[writer->size++] = (char)value;
 }
 
-// Pseudo-uniform random between min_ and max_
-unsigned int superrandom(unsigned int min_, unsigned int max_){
+// printf into buffer. Pieces longer than outputWriterMaxPiece are written through stdio.
+void writerPrintf(OutputWriter *writer, const char *format, ...){
+	va_list args;
+	writerReserve(writer, outputWriterMaxPiece);
+	va_start(args, format);
+	int length = vsnprintf(writer->buffer + writer->size, outputWriterMaxPiece, format, args);
+	va_end(args);
+	if(length < outputWriterMaxPiece){
+		writer->size += max2(length, 0);
+		return;
+	}
+	writerFlush(writer);
+	va_start(args, format);
+	vfprintf(writer->file, format, args);
+	va_end(args);
+}
+
+// String as JSON string literal, with quotes and escapes
+void writerPutJSONString(OutputWriter *writer, const char *str){
+	writerPutChar(writer, '"');
+	for(; *str != '\0'; str++){
+		unsigned char c = (unsigned char)*str;
+		if(c == '"' || c == '\\'){ writerPutChar(writer, '\\'); writerPutChar(writer, (char)c); }
+		else if(c == '\n') writerPutString(writer, "\\n");
+		else if(c < 0x20) writerPrintf(writer, "\\u%04x", c);
+		else writerPutChar(writer, (char)c);
+	} writerPutChar(writer, '"');
+}
+
+// String as CSV field, quoted only if it has comma, quote or line break
+void writerPutCSVField(OutputWriter *writer, const char *str){
+	if(strpbrk(str, ",\"\r\n") == NULL){ writerPutString(writer, str); return; }
+	writerPutChar(writer, '"');
+	for(; *str != '\0'; str++){
+		if(*str == '"') writerPutChar(writer, '"');
+		writerPutChar(writer, *str);
+	} writerPutChar(writer, '"');
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Random
+
+// Random stream: xoshiro256** generator. Each stream has its own state, so streams can be used in parallel,
+// and (seed, streamID) always recreates same sequence.
+struct RandomStream__{
+	unsigned long long state[4];
+}; typedef struct RandomStream__ RandomStream;
+
+// SplitMix64 step, used to expand single seed into full state
+unsigned long long splitMix64(unsigned long long *x){
+	unsigned long long z = (*x += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+// Seed given stream. Different stream IDs with same seed give independent sequences.
+void seedRandomStream(RandomStream *rs, unsigned long long seed, unsigned long long streamID){
+	unsigned long long x = seed ^ (streamID * 0xD1B54A32D192ED03ULL);
+	for(int i=0; i<4; i++) rs->state[i] = splitMix64(&x);
+}
+
+// Uniform 64 bits
+unsigned long long nextRandom(RandomStream *rs){
+	unsigned long long *s = rs->state;
+	unsigned long long x = s[1] * 5, result = ((x << 7) | (x >> 57)) * 9, t = s[1] << 17;
+	s[2] ^= s[0]; s[3] ^= s[1]; s[1] ^= s[2]; s[0] ^= s[3];
+	s[2] ^= t; s[3] = (s[3] << 45) | (s[3] >> 19);
+	return result;
+}
+
+// Unbiased uniform random between min_ and max_ (Lemire's multiply-shift with rejection)
+unsigned int randomRange(RandomStream *rs, unsigned int min_, unsigned int max_){
 	if(min_ > max_){
 		printf("[Error] Min value(%u) is bigger than max value(%u)\n", min_, max_);
 		return -1;
 	}
-	return (unsigned int)randomBits(false) % (max_ - min_ + 1) + min_;
+	unsigned int range = max_ - min_ + 1;
+	if(range == 0) return (unsigned int)(nextRandom(rs) >> 32); // Whole 32 bits range
+	unsigned long long m = (nextRandom(rs) >> 32) * range;
+	if((unsigned int)m < range){
+		unsigned int threshold = (0u - range) % range;
+		while((unsigned int)m < threshold) m = (nextRandom(rs) >> 32) * range;
+	} return (unsigned int)(m >> 32) + min_;
+}
+
+// Fill buffer with uniform randoms between min_ and max_
+void fillRandomRange(RandomStream *rs, unsigned int *buffer, int count, unsigned int min_, unsigned int max_){
+	for(int i=0; i<count; i++) buffer[i] = randomRange(rs, min_, max_);
+}
+
+// Global stream, used by superrandom. Seeded with current time if setRandomSeed is not called before.
+RandomStream globalRandomStream;
+unsigned long long globalRandomSeed = 0;
+bool globalRandomSeeded = false;
+void setRandomSeed(unsigned long long seed){
+	globalRandomSeed = seed;
+	seedRandomStream(&globalRandomStream, seed, 0);
+	globalRandomSeeded = true;
+}
+
+// Pseudo-uniform random between min_ and max_ from global stream. Not thread safe, use randomRange in threads.
+unsigned int superrandom(unsigned int min_, unsigned int max_){
+	if(!globalRandomSeeded) setRandomSeed((unsigned long long)time(NULL));
+	return randomRange(&globalRandomStream, min_, max_);
 }
 
 // --------------------------------------------------------------------------------------------------------------------
 // Process structure
 
-// Nonce for identifying process uniquely
+// Nonce for identifying process uniquely. Taken atomically since sweep creates processes on multiple threads.
 static int processCounter = 1;
 typedef enum {
 	criteria_FCFS, criteria_SJF, criteria_P,
-	criteria_AGING, criteria_RR, criteria_PDy
+	criteria_AGING, criteria_RR, criteria_PDy,
+	criteria_MLFQ, criteria_CFS,
+	criteria_COUNT // Number of criterias; Tables indexed by criteria are sized by it
 } ProcessComparisonCriteria;
-const bool ProcessComparisonTicking[6] = {false, false, false, true, false, false};
-const char ProcessComparisonNames[6][100] = 
+const bool ProcessComparisonTicking[criteria_COUNT] = {false, false, false, true, false, false, false, false};
+const char ProcessComparisonNames[criteria_COUNT][100] = 
 	{"CriteriaFCFS", "CriteriaSJF", "CriteriaPriority", "CriteriaAging", "CriteriaRoundRobin",
-	 "CriteriaPriorityDynamic"};
-const double agingFactor = pow(0.75, 1);
+	 "CriteriaPriorityDynamic", "CriteriaMultilevelFeedback", "CriteriaCompletelyFair"};
+
+// Aging formula. Each process has cached key, which depends only on its arrival time and CPU burst left, so it changes
+// only while the process runs. Process with the smallest key is picked, and equal keys are broken by smaller PID.
+//   AgingFormulaExponential: key = -log(agingFactor) * arrival - log(1 + CPUburstleft)
+//   AgingFormulaLinear: key = agingFactor * arrival - (1 + CPUburstleft)
+// So earlier arrival and more CPU burst left both make key smaller. agingFactor is in (0, 1) for exponential formula
+// and positive for linear one.
+typedef enum {AgingFormulaExponential, AgingFormulaLinear} AgingFormula;
+struct AgingConfig__{
+	AgingFormula formula;
+	double agingFactor;
+	double arrivalWeight; // Precomputed coefficient of arrival time in key
+}; typedef struct AgingConfig__ AgingConfig;
+const AgingConfig defaultAgingConfig = {AgingFormulaExponential, 0.75, 0.28768207245178090}; // arrivalWeight = -log(0.75)
+
+// Aging config of given formula and factor. Invalid factor gives default config.
+AgingConfig newAgingConfig(AgingFormula formula, double agingFactor){
+	if(agingFactor <= 0 || (formula == AgingFormulaExponential && agingFactor >= 1)){
+		printf("[Warning] Invalid aging factor(%f) given in newAgingConfig, default is used.\n", agingFactor);
+		return defaultAgingConfig;
+	}
+	AgingConfig config = {formula, agingFactor, formula == AgingFormulaExponential ? -log(agingFactor) : agingFactor};
+	return config;
+}
 
 // Struct
 struct Process__{
 	
 	// Native features
 	int PID;
-	int CPUburst, IOburst;
+	int CPUburst, IOburst; // CPUburst is total CPU time, IOburst is length of each I/O burst
+	int IOcount; // CPU burst is split into (IOcount + 1) bursts, and I/O bursts are done between them
 	int arrivalTime;
 	int givenPriority; // Small priority value means high priority
 	
 	// Statistics
-	bool RRcycleUsed; // For Round Robin
 	int CPUburstleft;
 	int finishedTime;
+	double agingKey; // Cached time invariant part of aged priority, see AgingFormula
 	
 }; typedef struct Process__ Process;
 
+// Aging key of process with given arrival time and CPU burst left
+double agingKeyOf(const AgingConfig *config, int arrivalTime, int CPUburstleft){
+	if(config->formula == AgingFormulaExponential) return config->arrivalWeight * arrivalTime - log(1.0 + CPUburstleft);
+	else return config->arrivalWeight * arrivalTime - (1.0 + CPUburstleft);
+}
+
+// Compare two aging keys exactly: -1 if key1 has higher priority, 1 if key2 has, 0 if tie.
+// Keys are always computed by agingKeyOf from integers, so same inputs give same key and exact ties are broken by PID.
+int compareAgingKeys(double key1, double key2){
+	return key1 < key2 ? -1 : (key1 > key2 ? 1 : 0);
+}
+
+// Refresh cached aging key with default config. Should be called whenever arrivalTime or CPUburstleft is changed.
+// Process tables keep keys by their own config, see ProcessTable.
+void refreshAgingKey(Process *p){
+	p->agingKey = agingKeyOf(&defaultAgingConfig, p->arrivalTime, p->CPUburstleft);
+}
+
 // Return True if p1 < p2, otherwise False.
-int processComparisonValues_timelinetimestamp = -1;
 bool processComparisonGT(Process p1, Process p2, ProcessComparisonCriteria criteria){
-	double calculatedValue1, calculatedValue2;
+	instrumentCount(CounterComparisons, 1);
 	switch(criteria){ // PID comparison is final method, it's used after this switch
 		case criteria_FCFS: // (arrivalTime)
 			if(p1.arrivalTime != p2.arrivalTime) return p1.arrivalTime < p2.arrivalTime;
@@ -135,55 +439,63 @@ bool processComparisonGT(Process p1, Process p2, ProcessComparisonCriteria crite
 		case criteria_PDy:
 			if(p1.givenPriority != p2.givenPriority) return p1.givenPriority < p2.givenPriority;
 			else break;
-		case criteria_AGING: // (aged priority = CPUburstleft * agingFactor ** age)
-			calculatedValue1 = pow(agingFactor, processComparisonValues_timelinetimestamp - p1.arrivalTime) / (double)(1 + p1.CPUburstleft);
-			calculatedValue2 = pow(agingFactor, processComparisonValues_timelinetimestamp - p2.arrivalTime) / (double)(1 + p2.CPUburstleft);
-			if(calculatedValue1 != calculatedValue2) return calculatedValue1 < calculatedValue2;
-			else break;
-		case criteria_RR: // (consumed count)
-			if(p1.RRcycleUsed == true && p2.RRcycleUsed == false) return false;
-			else if(p1.RRcycleUsed == false && p2.RRcycleUsed == true) return true;
+		case criteria_AGING: // (cached aging key, see AgingFormula)
+			if(compareAgingKeys(p1.agingKey, p2.agingKey) != 0) return p1.agingKey < p2.agingKey;
 			else break;
+		case criteria_RR: // Round robin and MLFQ use FIFO run queues, CFS uses virtual runtime instead of comparison
+		case criteria_MLFQ:
+		case criteria_CFS:
+		case criteria_COUNT:
+			break;
 	} return p1.PID < p2.PID;
 }
 
 // Create new process with automatically generated PID
 Process createProcess(int CPUburst, int IOburst, int arrivalTime, int givenPriority){
 	Process newCreatedOne;
-	newCreatedOne.PID = processCounter++;
+	newCreatedOne.PID = __atomic_fetch_add(&processCounter, 1, __ATOMIC_RELAXED);
 	newCreatedOne.CPUburst = CPUburst, newCreatedOne.IOburst = IOburst;
+	newCreatedOne.IOcount = 0;
 	newCreatedOne.arrivalTime = arrivalTime;
 	newCreatedOne.givenPriority = givenPriority;
 	newCreatedOne.CPUburstleft = CPUburst;
 	newCreatedOne.finishedTime = 0;
-	newCreatedOne.RRcycleUsed = false;
+	refreshAgingKey(&newCreatedOne);
 	return newCreatedOne;
 }
 Process* createProcessAlloc(int CPUburst, int IOburst, int arrivalTime, int givenPriority){
-	Process* newCreatedOne = (Process*)malloc(sizeof(Process));
+	Process* newCreatedOne = (Process*)countedMalloc(sizeof(Process));
 	*newCreatedOne = createProcess(CPUburst, IOburst, arrivalTime, givenPriority);
 	return newCreatedOne;
 }
 
-// Create random process
-Process createRandomProcess(
+// Give process IOcount I/O bursts of given length. Every CPU burst should be at least 1,
+// so IOcount is limited to CPUburst - 1. Zero length I/O burst means no I/O.
+void setProcessIO(Process *p, int IOburst, int IOcount){
+	p->IOburst = IOburst;
+	p->IOcount = (IOburst <= 0 ? 0 : max2(0, min2(IOcount, p->CPUburst - 1)));
+}
+
+// Create random process from given random stream
+Process createRandomProcess(RandomStream *rs,
 		int maxCPUburst, int maxIOburst, int minimumArrival, int maximumArrival, 
 		int minPriority, int maxPriority){
-	return createProcess(superrandom(1, maxCPUburst), superrandom(0, maxIOburst), 
-		superrandom(minimumArrival, maximumArrival), superrandom(minPriority, maxPriority));
+	int CPUburst = randomRange(rs, 1, maxCPUburst), IOburst = randomRange(rs, 0, maxIOburst);
+	int arrivalTime = randomRange(rs, minimumArrival, maximumArrival), givenPriority = randomRange(rs, minPriority, maxPriority);
+	return createProcess(CPUburst, IOburst, arrivalTime, givenPriority);
 }
-Process* createRandomProcessAlloc(
+Process* createRandomProcessAlloc(RandomStream *rs,
 		int maxCPUburst, int maxIOburst, int minimumArrival, int maximumArrival, 
 		int minPriority, int maxPriority){
-	Process* newCreatedOne = (Process*)malloc(sizeof(Process));
-	*newCreatedOne = createRandomProcess(maxCPUburst, maxIOburst, 
+	Process* newCreatedOne = (Process*)countedMalloc(sizeof(Process));
+	*newCreatedOne = createRandomProcess(rs, maxCPUburst, maxIOburst, 
 		minimumArrival, maximumArrival, minPriority, maxPriority);
 	return newCreatedOne;
 }
 
 // Deep copy
 Process* deepCopyProcesses(Process *origins, int processNum){
-	Process *newProcesses = (Process*)malloc(sizeof(Process) * processNum);
+	Process *newProcesses = (Process*)countedMalloc(sizeof(Process) * processNum);
 	for(int i=0; i<processNum; i++) *(newProcesses+i) = *(origins+i);
 	return newProcesses;
 }
@@ -193,21 +505,40 @@ typedef enum {
 	ProcessRepresentMinimal, ProcessRepresentBurst,
 	ProcessRepresentStatistics 
 } ProcessRepresentingMode;
-void reprSingleProcess(Process *p, ProcessRepresentingMode mode){
-	if(p == NULL) printf("[Process NULL]");
-	else switch(mode){
+#define processReprMaxLength 256
+int formatSingleProcess(char *buffer, Process *p, ProcessRepresentingMode mode){ // Buffer should have processReprMaxLength space
+	if(p == NULL) return snprintf(buffer, processReprMaxLength, "[Process NULL]");
+	char IOcountRepr[16] = ""; // Shown only if process has real I/O bursts
+	if(p->IOcount > 0) snprintf(IOcountRepr, sizeof(IOcountRepr), " x%d", p->IOcount);
+	switch(mode){
 		case ProcessRepresentMinimal:
-			printf("[Process #%03d: CPU burst %03d, I/O burst %03d, arrival time %03d, given priority = %03d]",
-				p->PID, p->CPUburst, p->IOburst, p->arrivalTime, p->givenPriority); break;
+			return snprintf(buffer, processReprMaxLength, "[Process #%03d: CPU burst %03d, I/O burst %03d%s, arrival time %03d, given priority = %03d]",
+				p->PID, p->CPUburst, p->IOburst, IOcountRepr, p->arrivalTime, p->givenPriority);
 		case ProcessRepresentBurst:
-			printf("[Process #%03d: CPU burst %03d (%03d left), I/O burst %03d, arrival time %03d, given priority = %03d]",
-				p->PID, p->CPUburst, p->CPUburstleft, p->IOburst, p->arrivalTime, p->givenPriority); break;
+			return snprintf(buffer, processReprMaxLength, "[Process #%03d: CPU burst %03d (%03d left), I/O burst %03d%s, arrival time %03d, given priority = %03d]",
+				p->PID, p->CPUburst, p->CPUburstleft, p->IOburst, IOcountRepr, p->arrivalTime, p->givenPriority);
 		case ProcessRepresentStatistics:
-			printf("[Process #%03d: CPU %03d, I/O %03d, Arrival %03d, Prio = %03d, Turnaround = %03d, Waiting = %03d]",
-				p->PID, p->CPUburst, p->IOburst, p->arrivalTime, p->givenPriority, p->finishedTime - p->arrivalTime, 
-				p->finishedTime - p->arrivalTime - p->CPUburst); break;
+			return snprintf(buffer, processReprMaxLength, "[Process #%03d: CPU %03d, I/O %03d%s, Arrival %03d, Prio = %03d, Turnaround = %03d, Waiting = %03d]",
+				p->PID, p->CPUburst, p->IOburst, IOcountRepr, p->arrivalTime, p->givenPriority, p->finishedTime - p->arrivalTime, 
+				p->finishedTime - p->arrivalTime - p->CPUburst - p->IOcount * p->IOburst);
+	} return 0;
+}
+void fprintSingleProcess(FILE *out, Process *p, ProcessRepresentingMode mode){
+	char buffer[processReprMaxLength];
+	formatSingleProcess(buffer, p, mode);
+	fputs(buffer, out);
+}
+void writeSingleProcess(OutputWriter *writer, Process *p, ProcessRepresentingMode mode){
+	writerReserve(writer, processReprMaxLength);
+	writer->size += min2(formatSingleProcess(writer->buffer + writer->size, p, mode), processReprMaxLength - 1);
+}
+void writeMultiProcesses(OutputWriter *writer, Process *p, int limit, ProcessRepresentingMode mode){
+	writerPutString(writer, "Representing processes:\n");
+	for(int i=0; i<limit; i++){
+		writerPutString(writer, "  "); writeSingleProcess(writer, p+i, mode); writerPutChar(writer, '\n');
 	}
 }
+void reprSingleProcess(Process *p, ProcessRepresentingMode mode){fprintSingleProcess(stdout, p, mode);}
 void reprMultiProcesses(Process *p, int limit, ProcessRepresentingMode mode){
 	printf("Representing processes:\n");
 	for(int i=0; i<limit; i++){
@@ -215,6 +546,216 @@ void reprMultiProcesses(Process *p, int limit, ProcessRepresentingMode mode){
 	}
 }
 
+// --------------------------------------------------------------------------------------------------------------------
+// Workload generator
+
+// Distribution of sampled integers. Meaning of parameters:
+//   DistributionUniform: [param1, param2]
+//   DistributionExponential: mean = param1
+//   DistributionPareto: scale = param1, shape = param2 (heavy tailed if shape <= 2)
+//   DistributionBimodal: exponential with mean param1, or mean param2 with probability param3
+typedef enum {
+	DistributionUniform, DistributionExponential, 
+	DistributionPareto, DistributionBimodal
+} DistributionKind;
+struct Distribution__{
+	DistributionKind kind;
+	double param1, param2, param3;
+	int minValue, maxValue; // Samples are clamped into [minValue, maxValue]
+}; typedef struct Distribution__ Distribution;
+
+// Construct distributions
+Distribution newDistribution(DistributionKind kind, double param1, double param2, double param3, int minValue, int maxValue){
+	Distribution newCreatedOne;
+	newCreatedOne.kind = kind;
+	newCreatedOne.param1 = param1, newCreatedOne.param2 = param2, newCreatedOne.param3 = param3;
+	newCreatedOne.minValue = minValue, newCreatedOne.maxValue = maxValue;
+	return newCreatedOne;
+}
+
+// Uniform real number in (0, 1]
+double randomUnit(RandomStream *rs){
+	return (double)((nextRandom(rs) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+// Sample single integer from distribution
+int sampleDistribution(RandomStream *rs, Distribution *dist){
+	double sampled;
+	switch(dist->kind){
+		case DistributionUniform:
+			sampled = dist->param1 + floor((1.0 - randomUnit(rs)) * (dist->param2 - dist->param1 + 1)); break;
+		case DistributionExponential:
+			sampled = -dist->param1 * log(randomUnit(rs)); break;
+		case DistributionPareto:
+			sampled = dist->param1 / pow(randomUnit(rs), 1.0 / dist->param2); break;
+		case DistributionBimodal:
+			sampled = -(randomUnit(rs) <= dist->param3 ? dist->param2 : dist->param1) * log(randomUnit(rs)); break;
+		default:
+			sampled = dist->minValue;
+	}
+	if(sampled < dist->minValue) return dist->minValue;
+	else if(sampled > dist->maxValue) return dist->maxValue;
+	else return (int)sampled;
+}
+
+// Workload configuration. Arrival times are cumulative sums of sampled inter-arrival times.
+struct WorkloadConfig__{
+	Distribution CPUburst, IOburst, IOcount, interArrival;
+	int minPriority, maxPriority;
+}; typedef struct WorkloadConfig__ WorkloadConfig;
+
+// Generated workload in structure of arrays layout. Processes are already sorted by (arrivalTime, PID).
+struct Workload__{
+	int processNum;
+	int *PID, *CPUburst, *IOburst, *IOcount, *arrivalTime, *givenPriority;
+}; typedef struct Workload__ Workload;
+
+// Create new one with uninitialized arrays
+Workload* newWorkload(int processNum){
+	Workload *newCreatedOne = (Workload*)countedMalloc(sizeof(Workload));
+	newCreatedOne->processNum = processNum;
+	newCreatedOne->PID = (int*)countedMalloc(sizeof(int) * processNum);
+	newCreatedOne->CPUburst = (int*)countedMalloc(sizeof(int) * processNum);
+	newCreatedOne->IOburst = (int*)countedMalloc(sizeof(int) * processNum);
+	newCreatedOne->IOcount = (int*)countedMalloc(sizeof(int) * processNum);
+	newCreatedOne->arrivalTime = (int*)countedMalloc(sizeof(int) * processNum);
+	newCreatedOne->givenPriority = (int*)countedMalloc(sizeof(int) * processNum);
+	return newCreatedOne;
+}
+
+// Delete workload itself
+void deleteWorkload(Workload *workload){
+	free(workload->PID); free(workload->CPUburst); free(workload->IOburst); free(workload->IOcount);
+	free(workload->arrivalTime); free(workload->givenPriority);
+	free(workload);
+}
+
+// Processes are generated in chunks, and chunk k always uses random stream k+1 of the seed.
+// So result only depends on (config, processNum, seed), not on the number of threads.
+#define workloadChunkSize (1<<16)
+struct WorkloadChunkJob__{
+	WorkloadConfig *config;
+	Workload *workload;
+	unsigned long long seed;
+	int firstChunk, chunkStep;
+}; typedef struct WorkloadChunkJob__ WorkloadChunkJob;
+
+// Generate chunks firstChunk, firstChunk + chunkStep, ... Arrival array gets inter-arrival times. Can be used as thread routine.
+void* generateWorkloadChunks(void *arg){
+	WorkloadChunkJob *job = (WorkloadChunkJob*)arg;
+	Workload *workload = job->workload;
+	int chunkNum = (workload->processNum + workloadChunkSize - 1) / workloadChunkSize;
+	for(int chunk = job->firstChunk; chunk < chunkNum; chunk += job->chunkStep){
+		RandomStream rs; seedRandomStream(&rs, job->seed, chunk + 1);
+		int start = chunk * workloadChunkSize, end = min2(workload->processNum, start + workloadChunkSize);
+		for(int i=start; i<end; i++){
+			workload->CPUburst[i] = sampleDistribution(&rs, &job->config->CPUburst);
+			workload->IOburst[i] = sampleDistribution(&rs, &job->config->IOburst);
+			workload->arrivalTime[i] = sampleDistribution(&rs, &job->config->interArrival);
+			workload->givenPriority[i] = randomRange(&rs, job->config->minPriority, job->config->maxPriority);
+			workload->IOcount[i] = sampleDistribution(&rs, &job->config->IOcount);
+		}
+	} return NULL;
+}
+
+// Generate workload using threadNum threads. Return NULL if arrival time overflows.
+Workload* generateWorkload(WorkloadConfig *config, int processNum, unsigned long long seed, int threadNum){
+	if(processNum <= 0 || config->minPriority > config->maxPriority){
+		printf("[Error] Invalid process num(%d) or priority range(%d, %d) given in generateWorkload\n",
+			processNum, config->minPriority, config->maxPriority);
+		return NULL;
+	}
+	Workload *workload = newWorkload(processNum);
+	
+	// Sampling
+	threadNum = max2(1, threadNum);
+	WorkloadChunkJob *jobs = (WorkloadChunkJob*)countedMalloc(sizeof(WorkloadChunkJob) * threadNum);
+	pthread_t *threads = (pthread_t*)countedMalloc(sizeof(pthread_t) * threadNum);
+	for(int t=0; t<threadNum; t++){
+		jobs[t].config = config, jobs[t].workload = workload, jobs[t].seed = seed;
+		jobs[t].firstChunk = t, jobs[t].chunkStep = threadNum;
+		if(t > 0 && pthread_create(threads + t, NULL, generateWorkloadChunks, jobs + t) != 0){
+			jobs[t].chunkStep = -1; // Failed to create thread; Run it on this thread later.
+		}
+	}
+	for(int t=0; t<threadNum; t++){
+		if(t == 0 || jobs[t].chunkStep == -1){
+			jobs[t].chunkStep = threadNum;
+			generateWorkloadChunks(jobs + t);
+		}
+		else pthread_join(threads[t], NULL);
+	}
+	free(jobs); free(threads);
+	
+	// Inter-arrival times to arrival times, and PIDs reserved as one block
+	long long arrival = 0;
+	int firstPID = __atomic_fetch_add(&processCounter, processNum, __ATOMIC_RELAXED);
+	for(int i=0; i<processNum; i++){
+		arrival += workload->arrivalTime[i];
+		if(arrival >= inf){
+			printf("[Error] Arrival time overflowed at process %d in generateWorkload\n", i);
+			deleteWorkload(workload);
+			return NULL;
+		}
+		workload->arrivalTime[i] = (int)arrival;
+		workload->PID[i] = firstPID + i;
+	} return workload;
+}
+
+// Convert workload into process array
+Process* workloadToProcesses(Workload *workload){
+	Process *processes = (Process*)countedMalloc(sizeof(Process) * workload->processNum);
+	for(int i=0; i<workload->processNum; i++){
+		Process *p = processes + i;
+		p->PID = workload->PID[i];
+		p->CPUburst = p->CPUburstleft = workload->CPUburst[i];
+		setProcessIO(p, workload->IOburst[i], workload->IOcount[i]);
+		p->arrivalTime = workload->arrivalTime[i];
+		p->givenPriority = workload->givenPriority[i];
+		p->finishedTime = 0;
+		refreshAgingKey(p);
+	} return processes;
+}
+
+// Kind of randomized workload which schedulingTests, benchmark and sweep use
+typedef enum {WorkloadUniform, WorkloadHeavyTailed} WorkloadKind;
+const char *WorkloadKindNames[] = {"uniform", "heavy"};
+static WorkloadKind globalWorkloadKind = WorkloadUniform;
+
+// Heavy tailed and bursty workload of given scales. CPU bursts are Pareto with shape 1.5 and mean burstScale, capped 
+// at 100 times of it. Inter-arrival times are short mostly but 11 times longer with probability 0.1, so processes 
+// come in bursts, and mean is arrivalScale. Means are before rounding down. I/O bursts are bimodal in the same way.
+WorkloadConfig heavyTailedWorkloadConfig(int burstScale, int arrivalScale, int IOcount){
+	WorkloadConfig config;
+	config.CPUburst = newDistribution(DistributionPareto, burstScale / 3.0, 1.5, 0, 1, min2(burstScale, inf / 100) * 100);
+	config.interArrival = newDistribution(DistributionBimodal, 0.5 * arrivalScale, 5.5 * arrivalScale, 0.1, 0, inf);
+	if(IOcount > 0) config.IOburst = newDistribution(DistributionBimodal, max2(1, burstScale / 5), 2.0 * burstScale, 0.1, 1, inf);
+	else config.IOburst = newDistribution(DistributionUniform, 0, 0, 0, 0, 0);
+	config.IOcount = newDistribution(DistributionUniform, IOcount, IOcount, 0, IOcount, IOcount);
+	config.minPriority = 1, config.maxPriority = 5;
+	return config;
+}
+
+// Randomize processNum processes of given scales from given stream of seed. Uniform one has CPU bursts in 
+// [1, burstScale], arrival time of process i in [0, i * arrivalScale], and I/O bursts in [1, burstScale] if IOcount > 0.
+// Heavy tailed one is generated by threadNum threads from seed drawn from the stream, and already sorted by arrival.
+Process* randomizeProcesses(WorkloadKind kind, unsigned long long seed, unsigned long long stream, 
+		int processNum, int burstScale, int arrivalScale, int IOcount, int threadNum){
+	RandomStream rs; seedRandomStream(&rs, seed, stream);
+	if(kind == WorkloadHeavyTailed){
+		WorkloadConfig config = heavyTailedWorkloadConfig(burstScale, arrivalScale, IOcount);
+		Workload *workload = generateWorkload(&config, processNum, nextRandom(&rs), threadNum);
+		if(workload == NULL) exit(-1);
+		Process *processes = workloadToProcesses(workload);
+		deleteWorkload(workload);
+		return processes;
+	}
+	Process *processes = (Process*)countedMalloc(sizeof(Process) * processNum);
+	for(int i=0; i<processNum; i++) processes[i] = createRandomProcess(&rs, burstScale, 2, 0, i * arrivalScale, 1, 5);
+	if(IOcount > 0) for(int i=0; i<processNum; i++) setProcessIO(processes + i, randomRange(&rs, 1, burstScale), IOcount);
+	return processes;
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 // Naive scheduling
 // Given process array: *processes.
@@ -239,320 +780,3275 @@ void selectionSort(Process *processes, int start, int end, ProcessComparisonCrit
 	for(int i=start; i<end; i++) pick(processes, i, end, criteria);
 }
 
+// Check if processes in range [start, end) are already sorted with given criteria.
+bool isSorted(Process *processes, int start, int end, ProcessComparisonCriteria criteria){
+	for(int i=start+1; i<end; i++) if(processComparisonGT(*(processes+i), *(processes+i-1), criteria)) return false;
+	return true;
+}
+
+// Merge sort with given criteria in range [start, end), using buffer which has at least (end - start) space.
+void mergeSortRecursive(Process *processes, Process *buffer, int start, int end, ProcessComparisonCriteria criteria){
+	if(end - start <= 1) return;
+	int mid = (start + end) / 2;
+	mergeSortRecursive(processes, buffer, start, mid, criteria);
+	mergeSortRecursive(processes, buffer, mid, end, criteria);
+	if(!processComparisonGT(*(processes+mid), *(processes+mid-1), criteria)) return; // Already in order
+	int left = start, right = mid, k = 0;
+	while(left < mid && right < end){
+		if(processComparisonGT(*(processes+right), *(processes+left), criteria)) buffer[k++] = processes[right++];
+		else buffer[k++] = processes[left++];
+	}
+	while(left < mid) buffer[k++] = processes[left++];
+	while(right < end) buffer[k++] = processes[right++];
+	for(int i=0; i<k; i++) processes[start+i] = buffer[i];
+}
+
+// Merge sort with given criteria in range [start, end). Skipped if given range is already sorted.
+void mergeSort(Process *processes, int start, int end, ProcessComparisonCriteria criteria){
+	if(isSorted(processes, start, end, criteria)) return;
+	Process *buffer = (Process*)countedMalloc(sizeof(Process) * (end - start));
+	mergeSortRecursive(processes, buffer, start, end, criteria);
+	free(buffer);
+}
+
 // --------------------------------------------------------------------------------------------------------------------
-// Timeline structure
+// Trace reader
 
-// Timeline
-#define maxTimelineLength 10005
-struct Timeline__{
-	
-	// Nonarray attributes
-	int timelinesize, timestamp;
-	int processNum, contextswitchingcost;
-	Process *processes;
-	
-	// Timerelated attributes: [(usedProcessesPID[i], interval[i][0], interval[i][1]), ...]
-	// For all i, <PID = usedProcessesPID[i]> process did job in time interval [interval[i][0], interval[i][1])
-	int interval[maxTimelineLength][2];
-	int usedProcessesPID[maxTimelineLength]; // This can be null since CPU can kill time without doing any jobs
-	
-}; typedef struct Timeline__ Timeline;
+// Reads (arrival time, CPU burst, I/O burst, given priority) records one by one, so trace of any size is read in bounded memory.
+//   Text: Whitespace separated integers, 4 per record. '#' starts comment until end of line.
+//   Binary: "KUTR" and then records of 4 little-endian signed 32-bit integers.
+// Both formats can be read through stdio or memory mapping. Records should be sorted by arrival time.
+typedef enum {TraceFormatText, TraceFormatBinary} TraceFormat;
+struct TraceReader__{
+	TraceFormat format;
+	const char *path;
+	FILE *file; // NULL if memory mapped
+	const unsigned char *mapped;
+	size_t mappedSize, position;
+	long long recordNum;
+	int lastArrival;
+}; typedef struct TraceReader__ TraceReader;
 
-static int globalRRQuantumTime = 10;
+// Open trace file. Format is detected by magic. Return NULL if file can't be opened.
+TraceReader* openTraceReader(const char *path, bool memoryMapped){
+	TraceReader *reader = (TraceReader*)countedCalloc(1, sizeof(TraceReader));
+	reader->path = path;
+	unsigned char magic[4] = {0};
+	size_t magicSize = 0;
+	if(memoryMapped){
+		int fd = open(path, O_RDONLY);
+		struct stat info;
+		if(fd < 0 || fstat(fd, &info) != 0){
+			if(fd >= 0) close(fd);
+			free(reader);
+			return NULL;
+		}
+		reader->mappedSize = (size_t)info.st_size;
+		if(reader->mappedSize > 0){
+			void *mapped = mmap(NULL, reader->mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+			if(mapped == MAP_FAILED){
+				close(fd); free(reader);
+				return NULL;
+			}
+			madvise(mapped, reader->mappedSize, MADV_SEQUENTIAL);
+			reader->mapped = (const unsigned char*)mapped;
+		}
+		close(fd);
+		magicSize = (reader->mappedSize < 4 ? reader->mappedSize : 4);
+		if(magicSize > 0) memcpy(magic, reader->mapped, magicSize);
+	}
+	else{
+		reader->file = fopen(path, "rb");
+		if(reader->file == NULL){
+			free(reader);
+			return NULL;
+		}
+		magicSize = fread(magic, 1, 4, reader->file);
+	}
+	reader->format = (magicSize == 4 && memcmp(magic, "KUTR", 4) == 0) ? TraceFormatBinary : TraceFormatText;
+	if(reader->format == TraceFormatBinary) reader->position = 4;
+	else if(reader->file != NULL) rewind(reader->file);
+	return reader;
+}
 
-// Create new one
-Timeline newTimeline(Process *processes, int processNum, int contextswitchingcost){
-	Timeline newCreatedOne;
-	newCreatedOne.timelinesize = 0;
-	newCreatedOne.timestamp = 0;
-	newCreatedOne.processes = processes;
-	newCreatedOne.processNum = processNum;
-	newCreatedOne.contextswitchingcost = contextswitchingcost;
-	return newCreatedOne;
+// Close trace file and delete reader itself
+void closeTraceReader(TraceReader *reader){
+	if(reader->file != NULL) fclose(reader->file);
+	if(reader->mapped != NULL) munmap((void*)reader->mapped, reader->mappedSize);
+	free(reader);
 }
 
-// Make job. If given interval is bigger than given process's length then make interval lower
-// Parameter 'process' can be NULL if we intended to CPU kills time
-void doJobFor(Timeline *timeline, Process *process, int duration){
-	//printf("Do job process #%d for %d seconds\n", process == NULL ? -1 : process->PID, duration);
-	
-	// Critical validation
-	if(duration <= 0){ // Duration validation
-		printf("[Error] Invalid duration interval(%d) got in function doJobFor\n", duration);
-		exit(-1);
+// Next byte of trace, or EOF
+int traceReaderByte(TraceReader *reader){
+	if(reader->file != NULL) return getc_unlocked(reader->file);
+	return reader->position < reader->mappedSize ? reader->mapped[reader->position++] : EOF;
+}
+
+// Parse next integer of text trace into result. Return false if trace ended before any digit.
+bool traceReaderInt(TraceReader *reader, long long *result){
+	int c = traceReaderByte(reader);
+	while(c != EOF && (c == '#' || c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == ',')){
+		if(c == '#') while(c != EOF && c != '\n') c = traceReaderByte(reader);
+		else c = traceReaderByte(reader);
 	}
-	else if(process != NULL && process->CPUburstleft == 0){ // Tried to give job for burned process
-		printf("[Error] Given "); reprSingleProcess(process, ProcessRepresentMinimal); 
-		printf(" is already burned out in function doJobFor\n");
+	if(c == EOF) return false;
+	bool negative = (c == '-');
+	if(negative) c = traceReaderByte(reader);
+	if(c < '0' || c > '9'){
+		printf("[Error] Unexpected character '%c' in trace %s (record %lld)\n", c, reader->path, reader->recordNum + 1);
 		exit(-1);
 	}
-	
-	// Weak validation
-	if(process != NULL && process->CPUburstleft < duration){ // Duration modification
-		printf("[Warning] Given duration(%d) is larger than process's CPU burst left(%d), automatically fixed.\n",
-			duration, process->CPUburstleft);
-		duration = process->CPUburstleft;
-	}
-	
-	// Debug
-	/*printf("Timestamp %03d, timeline size %d, doing job = ", timeline->timestamp, timeline->timelinesize);
-	if(process == NULL) printf("<nothing>, "); else printf("<PID #%d>, ", process->PID);
-	printf("last used process = ");
-	if(timeline->timelinesize == 0 || timeline->usedProcessesPID[timeline->timelinesize - 1] == -1) printf("<nothing>, ");
-	else printf("<PID #%d>, ", timeline->usedProcessesPID[timeline->timelinesize - 1]); //printf("\n");*/
-	
-	// Timeline modification
-	if(timeline->timelinesize == 0 || 
-		(timeline->usedProcessesPID[timeline->timelinesize - 1] != -1 && process == NULL) || 
-		(process != NULL && timeline->usedProcessesPID[timeline->timelinesize - 1] != process->PID)){ // Append new one
-		//printf("Yeah it's different.\n");
-		if(process != NULL && timeline->timelinesize > 0 && 
-			timeline->usedProcessesPID[timeline->timelinesize - 1] != -1 &&
-			timeline->contextswitchingcost > 0) {
-			// Previous process and current processes are different and not null -> Add context switching cost
-			//printf("Adding context switching cost:\n");
-			doJobFor(timeline, NULL, timeline->contextswitchingcost);
+	long long value = 0;
+	while(c >= '0' && c <= '9'){
+		if(value < inf) value = value * 10 + (c - '0');
+		c = traceReaderByte(reader);
+	}
+	*result = negative ? -value : value;
+	return true;
+}
+
+// Read next record as new process. Return false if trace ended.
+bool traceReaderNext(TraceReader *reader, Process *p){
+	long long fields[4];
+	if(reader->format == TraceFormatText){
+		for(int i=0; i<4; i++) if(!traceReaderInt(reader, fields + i)){
+			if(i == 0) return false;
+			printf("[Error] Trace %s ended in the middle of record %lld\n", reader->path, reader->recordNum + 1);
+			exit(-1);
 		}
-		timeline->timestamp += duration;
-		timeline->usedProcessesPID[timeline->timelinesize] = (process == NULL ? -1 : process->PID);
-		timeline->interval[timeline->timelinesize][0] = timeline->timestamp - duration;
-		timeline->interval[timeline->timelinesize][1] = timeline->timestamp;
-		timeline->timelinesize++;
 	}
-	else{ // Modify latest one
-		//printf("No, it's modifying last one\n");
-		timeline->timestamp += duration;
-		timeline->interval[timeline->timelinesize - 1][1] = timeline->timestamp;
+	else{
+		unsigned char bytes[16];
+		size_t got;
+		if(reader->file != NULL) got = fread(bytes, 1, 16, reader->file);
+		else{
+			got = reader->mappedSize - reader->position;
+			if(got > 16) got = 16;
+			memcpy(bytes, reader->mapped + reader->position, got);
+			reader->position += got;
+		}
+		if(got == 0) return false;
+		else if(got < 16){
+			printf("[Error] Trace %s ended in the middle of record %lld\n", reader->path, reader->recordNum + 1);
+			exit(-1);
+		}
+		for(int i=0; i<4; i++) fields[i] = (int)((unsigned int)bytes[4*i] | (unsigned int)bytes[4*i+1] << 8 |
+			(unsigned int)bytes[4*i+2] << 16 | (unsigned int)bytes[4*i+3] << 24);
 	}
 	
-	// Process modification
-	if(process != NULL){
-		process->CPUburstleft -= duration;
-		process->RRcycleUsed = true;
-		if(process->CPUburstleft == 0){
-			process->finishedTime = timeline->timestamp;
-			if(process->IOburst != 0) printf("[Random I/O] Random I/O performing from process #%d\n", process->PID);
-		}
+	// Validation
+	if(fields[0] < reader->lastArrival || fields[0] >= inf || fields[1] <= 0 || fields[1] >= inf || fields[2] < 0 || fields[2] >= inf
+		|| fields[3] <= -inf || fields[3] >= inf){
+		printf("[Error] Invalid or unsorted record %lld (%lld, %lld, %lld, %lld) in trace %s\n", reader->recordNum + 1,
+			fields[0], fields[1], fields[2], fields[3], reader->path);
+		exit(-1);
 	}
+	reader->lastArrival = (int)fields[0];
+	reader->recordNum++;
+	*p = createProcess((int)fields[1], (int)fields[2], (int)fields[0], (int)fields[3]);
+	return true;
 }
 
 // --------------------------------------------------------------------------------------------------------------------
-// Naive scheduling
-
-// General scheduling method
-Timeline ScheduleGeneral(Process *processes, int processNum, bool preemptive, 
-		ProcessComparisonCriteria criteria, int contextswitchingcost, bool detailedDebug,
-		const char *timelineTitle){
+// Process table
 
-	// Prefix decoration
-	printf("\n"); printRepeat("-", 80, false);
-	printf("\nScheduling for timeline %s.\n\n", timelineTitle);
+// Structure of arrays view of processes, used while scheduling. Processes are referred by index of this table,
+// so scheduling moves only indices, and scanning one key touches only one contiguous array.
+// Table read from trace is filled while scheduling, and processNum is number of slots used so far.
+// Overlay table shares native features of its base table, which is read only, and owns only what scheduling modifies.
+struct ProcessTable__{
+	int processNum, capacity;
+	const struct ProcessTable__ *base; // NULL if table owns its native features
 	
-	// Scheduling
-	Timeline timeline = newTimeline(processes, processNum, contextswitchingcost);
-	selectionSort(processes, 0, processNum, criteria_FCFS);
-	int start = 0, end = 0;
-	while(start < processNum){
-		
-		// Move front pointer until all processes come
-		while(end < processNum && processes[end].arrivalTime <= timeline.timestamp) end++;
-		
-		// Now we should check for [start, end)
-		int next_come = (end < processNum ? processes[end].arrivalTime : inf);
-		if(start == end){ // Nothing to do; Just wait until next process comes.
-			if(next_come == inf){
-				printf("[Error] Something wrong happened in ScheduleGeneral (%s), all processes done but loop is not ended.\n",
-					ProcessComparisonNames[criteria]);
-				exit(-1);
-			}
-			doJobFor(&timeline, NULL, next_come - timeline.timestamp);
-			continue;
-		}
-		
-		if(criteria == criteria_PDy){ // Dynamically changing priorities
-			int randomChangingIndex = superrandom(start, end-1);
-			int currentPriority = (processes + randomChangingIndex)->givenPriority;
-			(processes+randomChangingIndex)->givenPriority = superrandom(currentPriority / 2, currentPriority * 2 + 1);
-			if(detailedDebug) printf("Process #%d's priority changed from %d to %d\n", (processes+randomChangingIndex)->PID,
-				currentPriority, (processes+randomChangingIndex)->givenPriority);
-		}
-		
-		// Pick optimal processes
-		processComparisonValues_timelinetimestamp = timeline.timestamp;
-		int picked = pick(processes, start, end, criteria);
-		if(criteria == criteria_RR && (processes+start)->RRcycleUsed == true){ // For round robin: If all processes are used, refresh the cycle.
-			if(detailedDebug) printf("RoundRobin: All processes used cycle, refresh all cycles.\n");
-			for(int i=start; i<end; i++) (processes+i)->RRcycleUsed = false;
-			picked = pick(processes, start, end, criteria);
-		}
-		
-		if(detailedDebug){
-			printf("Timestamp %03d: Picked #%d from among\n", timeline.timestamp, (processes+start)->PID);
-			//for(int i=start; i<end; i++){
-			//	printf("  "); reprSingleProcess(processes + i, ProcessRepresentMinimal); printf("\n");
-			//}
-		}
-		
-		// Do job
-		if(criteria == criteria_RR) // If round-robin, then use quantum time
-			doJobFor(&timeline, processes+start, min2((processes+start)->CPUburstleft, globalRRQuantumTime));
-		else if(preemptive) // Do until next process comes
-			//printf("Preemptive: Doing %d seconds\n", max2(1, min2((processes+start)->CPUburstleft, next_come - timeline.timestamp))),
-			doJobFor(&timeline, processes+start, 
-				ProcessComparisonTicking[criteria] ? 1 : max2(1, min2((processes+start)->CPUburstleft, next_come - timeline.timestamp)));
-		else // Do all and go next
-			//printf("Non-preemptive: Doing %d seconds\n", (processes+start)->CPUburstleft),
-			doJobFor(&timeline, processes+start, (processes+start)->CPUburstleft);
-			
-		// If current process bursted then move back pointer
-		if((processes+start)->CPUburstleft == 0) start++;
-	} return timeline;
+	// Native features
+	int *PID, *CPUburst, *IOburst, *IOcount, *arrivalTime;
+	int *givenPriority;
+	
+	// Statistics
+	int *CPUburstleft, *finishedTime;
+	int *firstRunTime; // Time when process got CPU first, -1 if not yet
+	double *agingKey;
+	AgingConfig aging; // Config which agingKey is computed by, see setProcessTableAging
+	int *IOdone; // Number of finished I/O bursts
+	int *burstBoundary; // Current CPU burst ends when CPUburstleft reaches this value
+	bool refreshesAgingKeys; // If false, doJobFor skips agingKey since scheduling criteria doesn't read it
+	
+}; typedef struct ProcessTable__ ProcessTable;
+
+// CPUburstleft at the end of current CPU burst of table[index]. (k+1)-th CPU burst ends after CPUburst * (k+1) / (IOcount+1).
+int nextBurstBoundary(ProcessTable *table, int index){
+	if(table->IOdone[index] >= table->IOcount[index]) return 0;
+	long long used = (long long)table->CPUburst[index] * (table->IOdone[index] + 1) / (table->IOcount[index] + 1);
+	return table->CPUburst[index] - (int)used;
 }
 
-// --------------------------------------------------------------------------------------------------------------------
-// Gantt chart displaying
+// Resize all arrays of table to given capacity
+void resizeProcessTable(ProcessTable *table, int capacity){
+	#define resizeTableArray(array, type) table->array = (type*)countedRealloc(table->array, sizeof(type) * max2(capacity, 1))
+	resizeTableArray(PID, int); resizeTableArray(CPUburst, int); resizeTableArray(IOburst, int);
+	resizeTableArray(IOcount, int); resizeTableArray(arrivalTime, int); resizeTableArray(givenPriority, int);
+	resizeTableArray(CPUburstleft, int); resizeTableArray(finishedTime, int); resizeTableArray(firstRunTime, int);
+	resizeTableArray(agingKey, double);
+	resizeTableArray(IOdone, int); resizeTableArray(burstBoundary, int);
+	#undef resizeTableArray
+	table->capacity = capacity;
+}
 
-// Display Gantt chart
-void GanttChart(Timeline *timeline, const char *timelineTitle){
-	
-	// Validation
-	if(timeline->timelinesize == 0){
-		printf("[Warning] Tried to print empty timeline\n");
-		return;
+// Copy process into table[index]
+void setTableProcess(ProcessTable *table, int index, Process *p){
+	table->PID[index] = p->PID;
+	table->CPUburst[index] = p->CPUburst, table->IOburst[index] = p->IOburst, table->IOcount[index] = p->IOcount;
+	table->arrivalTime[index] = p->arrivalTime;
+	table->givenPriority[index] = p->givenPriority;
+	table->CPUburstleft[index] = p->CPUburstleft;
+	table->finishedTime[index] = p->finishedTime;
+	table->firstRunTime[index] = -1;
+	table->agingKey[index] = agingKeyOf(&table->aging, p->arrivalTime, p->CPUburstleft);
+	table->IOdone[index] = 0;
+	table->burstBoundary[index] = nextBurstBoundary(table, index);
+}
+
+// Create new table from process array. Index i of table is processes[i].
+ProcessTable* newProcessTable(Process *processes, int processNum){
+	ProcessTable *table = (ProcessTable*)countedCalloc(1, sizeof(ProcessTable));
+	resizeProcessTable(table, processNum);
+	table->processNum = processNum;
+	table->aging = defaultAgingConfig;
+	table->refreshesAgingKeys = true;
+	for(int i=0; i<processNum; i++) setTableProcess(table, i, processes + i);
+	return table;
+}
+
+// Create overlay of base table for scheduling by given criteria. Given priority is copied only if criteria
+// changes it, and aging keys are kept only if criteria reads them.
+ProcessTable* newProcessTableOverlay(const ProcessTable *base, ProcessComparisonCriteria criteria){
+	ProcessTable *table = (ProcessTable*)countedCalloc(1, sizeof(ProcessTable));
+	int processNum = base->processNum;
+	table->processNum = table->capacity = processNum;
+	table->base = base;
+	table->aging = base->aging;
+	table->PID = base->PID, table->CPUburst = base->CPUburst, table->IOburst = base->IOburst;
+	table->IOcount = base->IOcount, table->arrivalTime = base->arrivalTime;
+	table->givenPriority = base->givenPriority;
+	if(criteria == criteria_PDy){
+		table->givenPriority = (int*)countedMalloc(sizeof(int) * max2(processNum, 1));
+		memcpy(table->givenPriority, base->givenPriority, sizeof(int) * processNum);
 	}
-	
-	// Prefix decoration
-	printf("\n"); printRepeat("-", 80, false);
-	printf("\nGantt chart for timeline %s.\n\n", timelineTitle);
-	
-	// Main 1: Processes info
-	printf("Processes: \n");
-	for(int i=0; i<timeline->processNum; i++){
-		printf("  "); 
-		reprSingleProcess(timeline->processes + i, ProcessRepresentStatistics); 
-		printf("\n");
-	} printf("\n");
-	
-	// Main 2: Vertical Gantt chart
-	printf("Timeline: \n");
-	for(int i=0; i<timeline->timelinesize; i++){
-		printf("%4d +-----------+\n     | PID = ", timeline->interval[i][0]);
-		if(timeline->usedProcessesPID[i] == -1) printf("---");
-		else printf("%03d", timeline->usedProcessesPID[i]);
-		printf(" |\n");
-	} printf("%4d +-----------+\n\n", timeline->interval[timeline->timelinesize-1][1]);
-	
-	// Main 3: Calculate average turnaround time and waiting time.
-	int total_turnaround = 0, total_waiting = 0;
-	for(int i=0; i<timeline->processNum; i++){
-		int finished = timeline->processes[i].finishedTime, arrived = timeline->processes[i].arrivalTime;
-		total_turnaround += finished - arrived;
-		total_waiting += finished - arrived - timeline->processes[i].CPUburst;
-	} printf("Average turnaround %.2f, average waiting %.2f\n", 
-		(double)total_turnaround / timeline->processNum, (double)total_waiting / timeline->processNum);
+	#define allocateTableArray(array, type) table->array = (type*)countedMalloc(sizeof(type) * max2(processNum, 1))
+	allocateTableArray(CPUburstleft, int); allocateTableArray(finishedTime, int); allocateTableArray(firstRunTime, int);
+	allocateTableArray(IOdone, int); allocateTableArray(burstBoundary, int);
+	if(criteria == criteria_AGING) allocateTableArray(agingKey, double);
+	#undef allocateTableArray
+	table->refreshesAgingKeys = (criteria == criteria_AGING);
+	for(int i=0; i<processNum; i++){
+		table->CPUburstleft[i] = base->CPUburstleft[i];
+		table->finishedTime[i] = base->finishedTime[i];
+		table->firstRunTime[i] = -1;
+		table->IOdone[i] = 0;
+		table->burstBoundary[i] = nextBurstBoundary(table, i);
+		if(table->agingKey != NULL) table->agingKey[i] = agingKeyOf(&table->aging, table->arrivalTime[i], table->CPUburstleft[i]);
+	} return table;
+}
+
+// Use given aging config for table. Keys of processes already in table are recomputed if config differs.
+void setProcessTableAging(ProcessTable *table, const AgingConfig *aging){
+	if(table->aging.formula == aging->formula && table->aging.agingFactor == aging->agingFactor) return;
+	table->aging = *aging;
+	if(table->agingKey != NULL) for(int i=0; i<table->processNum; i++)
+		table->agingKey[i] = agingKeyOf(aging, table->arrivalTime[i], table->CPUburstleft[i]);
+}
+
+// Delete table itself. Native features of overlay belong to its base.
+void deleteProcessTable(ProcessTable *table){
+	if(table->base == NULL){
+		free(table->PID); free(table->CPUburst); free(table->IOburst); free(table->IOcount); free(table->arrivalTime);
+		free(table->givenPriority);
+	}
+	else if(table->givenPriority != table->base->givenPriority) free(table->givenPriority);
+	free(table->CPUburstleft); free(table->finishedTime); free(table->firstRunTime); free(table->agingKey);
+	free(table->IOdone); free(table->burstBoundary);
+	free(table);
+}
+
+// Rebuild single process from table
+Process processFromTable(ProcessTable *table, int index){
+	Process p;
+	p.PID = table->PID[index];
+	p.CPUburst = table->CPUburst[index], p.IOburst = table->IOburst[index], p.IOcount = table->IOcount[index];
+	p.arrivalTime = table->arrivalTime[index];
+	p.givenPriority = table->givenPriority[index];
+	p.CPUburstleft = table->CPUburstleft[index];
+	p.finishedTime = table->finishedTime[index];
+	p.agingKey = agingKeyOf(&table->aging, p.arrivalTime, p.CPUburstleft);
+	return p;
+}
+
+// Same as processComparisonGT, but compares table[i] and table[j].
+specialized bool tableComparisonGT(ProcessTable *table, int i, int j, ProcessComparisonCriteria criteria){
+	instrumentCount(CounterComparisons, 1);
+	switch(criteria){
+		case criteria_FCFS:
+			if(table->arrivalTime[i] != table->arrivalTime[j]) return table->arrivalTime[i] < table->arrivalTime[j];
+			else break;
+		case criteria_SJF:
+			if(table->CPUburstleft[i] != table->CPUburstleft[j]) return table->CPUburstleft[i] < table->CPUburstleft[j];
+			else if(table->givenPriority[i] != table->givenPriority[j]) return table->givenPriority[i] < table->givenPriority[j];
+			else break;
+		case criteria_P:
+		case criteria_PDy:
+			if(table->givenPriority[i] != table->givenPriority[j]) return table->givenPriority[i] < table->givenPriority[j];
+			else break;
+		case criteria_AGING:
+			if(compareAgingKeys(table->agingKey[i], table->agingKey[j]) != 0) return table->agingKey[i] < table->agingKey[j];
+			else break;
+		case criteria_RR:
+		case criteria_MLFQ:
+		case criteria_CFS:
+		case criteria_COUNT:
+			break;
+	} return table->PID[i] < table->PID[j];
 }
 
 // --------------------------------------------------------------------------------------------------------------------
-// Functionality testing
+// Argmin kernel
 
-// Testing selection sort on processes
-void SelectionSortFunctionalityTest(){
-	
-	// Process randomizing
-	const int processNum = 10;
-	Process *processes = (Process*)malloc(sizeof(Process) * processNum);
-	for(int i=0; i<processNum; i++) *(processes+i) = createRandomProcess(20, 0, 0, 10, 1, 5);
-	
-	// Sort in 3 different criterias
-	const char criteria_str[3][100] = {"FCFS", "SJF", "Priority"};
-	printf("Before sorted - "); reprMultiProcesses(processes, processNum, ProcessRepresentMinimal);
-	for(int criteria = 0; criteria < 3; criteria++){
-		selectionSort(processes, 0, processNum, criteria);
-		printf("\n\nAfter sorted by %s - ", criteria_str[criteria]);
-		reprMultiProcesses(processes, processNum, ProcessRepresentMinimal);
+// Position of minimum among keys[0, n) as unsigned 64-bit integers. First one is chosen if tied. n should be positive.
+int argminKeysScalar(const unsigned long long *keys, int n){
+	int best = 0;
+	for(int i=1; i<n; i++) if(keys[i] < keys[best]) best = i;
+	return best;
+}
+
+#ifdef useX86Kernels
+// Keys are XORed with sign bit, so signed 64-bit comparison gives unsigned order.
+__attribute__((target("avx2"))) int argminKeysAVX2(const unsigned long long *keys, int n){
+	if(n < 8) return argminKeysScalar(keys, n);
+	const __m256i sign = _mm256_set1_epi64x((long long)0x8000000000000000ULL), step = _mm256_set1_epi64x(4);
+	__m256i bestKey = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)keys), sign);
+	__m256i bestPos = _mm256_setr_epi64x(0, 1, 2, 3), pos = bestPos;
+	int i = 4;
+	for(; i + 4 <= n; i += 4){
+		pos = _mm256_add_epi64(pos, step);
+		__m256i key = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(keys + i)), sign);
+		__m256i smaller = _mm256_cmpgt_epi64(bestKey, key);
+		bestKey = _mm256_blendv_epi8(bestKey, key, smaller);
+		bestPos = _mm256_blendv_epi8(bestPos, pos, smaller);
 	}
-	free(processes);
+	long long laneKey[4], lanePos[4];
+	_mm256_storeu_si256((__m256i*)laneKey, bestKey); _mm256_storeu_si256((__m256i*)lanePos, bestPos);
+	int best = (int)lanePos[0];
+	for(int lane=1; lane<4; lane++){
+		if(laneKey[lane] < laneKey[0] || (laneKey[lane] == laneKey[0] && lanePos[lane] < best))
+			laneKey[0] = laneKey[lane], best = (int)lanePos[lane];
+	}
+	for(; i<n; i++) if(keys[i] < keys[best]) best = i;
+	return best;
 }
 
-// Evaluation
-void schedulingTests(int processNum, int burstScale, int arrivalScale, int contextSwitchingCost, bool detailedDebug){
-	
-	// Parameter evaluation
-	if(burstScale <= 0 || processNum <= 0 || arrivalScale < 0){
-		printf("[Error] Nonpositive process num(%d) or scalars(%d, %d) given - evaluation will be terminated.\n",
-			processNum, burstScale, arrivalScale);
-		exit(-1);
+// Same as AVX2 version with 2 lanes. _mm_cmpgt_epi64 needs SSE4.2.
+__attribute__((target("sse4.2"))) int argminKeysSSE42(const unsigned long long *keys, int n){
+	if(n < 4) return argminKeysScalar(keys, n);
+	const __m128i sign = _mm_set1_epi64x((long long)0x8000000000000000ULL), step = _mm_set1_epi64x(2);
+	__m128i bestKey = _mm_xor_si128(_mm_loadu_si128((const __m128i*)keys), sign);
+	__m128i bestPos = _mm_set_epi64x(1, 0), pos = bestPos;
+	int i = 2;
+	for(; i + 2 <= n; i += 2){
+		pos = _mm_add_epi64(pos, step);
+		__m128i key = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(keys + i)), sign);
+		__m128i smaller = _mm_cmpgt_epi64(bestKey, key);
+		bestKey = _mm_blendv_epi8(bestKey, key, smaller);
+		bestPos = _mm_blendv_epi8(bestPos, pos, smaller);
 	}
+	long long laneKey[2], lanePos[2];
+	_mm_storeu_si128((__m128i*)laneKey, bestKey); _mm_storeu_si128((__m128i*)lanePos, bestPos);
+	int best = (laneKey[1] < laneKey[0] || (laneKey[1] == laneKey[0] && lanePos[1] < lanePos[0])) ? (int)lanePos[1] : (int)lanePos[0];
+	for(; i<n; i++) if(keys[i] < keys[best]) best = i;
+	return best;
+}
+#endif
 
-	// Process randomizing
-	Process *processes = (Process*)malloc(sizeof(Process) * processNum);
-	for(int i=0; i<processNum; i++) *(processes+i) = createRandomProcess(burstScale, 2, 0, i * arrivalScale, 1, 5);
-	printf("Initial processes:\n");
-	reprMultiProcesses(processes, processNum, ProcessRepresentMinimal);
-	printRepeat("-", 60, false); printf("\n");
-	
-	// FCFS
-	Process *processesFCFS = deepCopyProcesses(processes, processNum);
-	Timeline FCFSscheduled = ScheduleGeneral(processesFCFS, processNum, false, criteria_FCFS, contextSwitchingCost, detailedDebug, "FCFS");
-	GanttChart(&FCFSscheduled, "FCFS");
-	
-	// SJF non preemptive
-	Process *processesSJF = deepCopyProcesses(processes, processNum);
-	Timeline SJFscheduled = ScheduleGeneral(processesSJF, processNum, false, criteria_SJF, contextSwitchingCost, detailedDebug, "SJF");
-	GanttChart(&SJFscheduled, "SJF");
-	
-	// SJF preemptive
-	Process *processesSJFP = deepCopyProcesses(processes, processNum);
-	Timeline SJFPscheduled = ScheduleGeneral(processesSJFP, processNum, true, criteria_SJF, contextSwitchingCost, detailedDebug, "SJF-preemptive");
-	GanttChart(&SJFPscheduled, "SJF-preemptive");
-	
-	// Priority non preemptive
-	Process *processesP = deepCopyProcesses(processes, processNum);
-	Timeline Pscheduled = ScheduleGeneral(processesP, processNum, false, criteria_P, contextSwitchingCost, detailedDebug, "Priority");
-	GanttChart(&Pscheduled, "Priority");
-	
-	// Priority preemptive
-	Process *processesPP = deepCopyProcesses(processes, processNum);
-	Timeline PPscheduled = ScheduleGeneral(processesPP, processNum, true, criteria_P, contextSwitchingCost, detailedDebug, "Priority-preemptive");
-	GanttChart(&PPscheduled, "Priority-preemptive");
-	
-	// Aging
-	Process *processesAG = deepCopyProcesses(processes, processNum);
-	Timeline AGscheduled = ScheduleGeneral(processesAG, processNum, true, criteria_AGING, contextSwitchingCost, detailedDebug, "CustomizedAging-preemptive");
-	GanttChart(&AGscheduled, "CustomizedAging-preemptive");
-	
-	// RR
-	Process *processesRR = deepCopyProcesses(processes, processNum);
-	Timeline RRscheduled = ScheduleGeneral(processesRR, processNum, false, criteria_RR, contextSwitchingCost, detailedDebug, "RoundRobin");
-	GanttChart(&RRscheduled, "RoundRobin");
-	printf("Round Robin Quantum time = %d\n", globalRRQuantumTime);
-	
-	// Priority dynamic preemptive
-	Process *processesPDP = deepCopyProcesses(processes, processNum);
-	Timeline PDPscheduled = ScheduleGeneral(processesPDP, processNum, true, criteria_PDy, contextSwitchingCost, detailedDebug, "DynamicPriority-preemptive");
-	GanttChart(&PDPscheduled, "DynamicPriority-preemptive");
+// Kernel chosen at runtime by CPU features
+int (*argminKeys)(const unsigned long long *keys, int n) = argminKeysScalar;
+pthread_once_t argminKernelSelected = PTHREAD_ONCE_INIT;
+void selectArgminKernel(){
+#ifdef useX86Kernels
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2")) argminKeys = argminKeysAVX2;
+	else if(__builtin_cpu_supports("sse4.2")) argminKeys = argminKeysSSE42;
+#endif
 }
 
 // --------------------------------------------------------------------------------------------------------------------
-// Main function
+// Data structure - Ready queue
 
-int main(void){
-	
-	//DequeFunctionalityTest1();
-	//SelectionSortFunctionalityTest();
+// Ready queue has two modes and switches between them by its size.
+//   Heap mode: heap[0, size) is binary min-heap of process table indices.
+//   Flat mode: heap[0, size) is unordered, keys[i] is packed key of heap[i] and top is found by argminKeys.
+//              Used for small ready sets where heap bookkeeping costs more than vectorized scanning.
+// Top is always the process which pick() would choose with same criteria.
+// Packed key is single unsigned 64-bit integer whose order is same as tableComparisonGT;
+// criterias without such key (aging) always use heap mode.
+// In both modes position[index] tracks where process index is in heap array(-1 if not in queue), so any process
+// can be updated or removed by its index in O(log n) without rebuilding.
+#define flatReadyQueueLimit 128 // Break-even point of AVX2 scanning and heap on SJF
+struct ReadyQueue__{
+	int *heap;
+	int size, capacity;
+	int *position, positionCapacity; // Indexed by process table index
+	ProcessTable *table;
+	ProcessComparisonCriteria criteria;
 	
-	printf("Welcome to the Minsung's CPU scheduling world!\n");
-	printf("Please input the number of processes(positive number): ");
+	// Flat mode
+	bool flat, packable;
+	unsigned long long *keys;
+	int topPosition; // Cached argmin position, -1 if not known
+	int PIDbits, priorityBits, priorityBase; // Packing layout for criteria_SJF
+}; typedef struct ReadyQueue__ ReadyQueue;
+
+// Number of bits to represent non-negative x
+int bitLength(unsigned long long x){
+	int bits = 0;
+	while(x > 0) bits++, x >>= 1;
+	return bits;
+}
+
+// Decide whether keys of given criteria can be packed for all processes in table
+void setReadyQueuePacking(ReadyQueue *rq){
+	ProcessTable *table = rq->table;
+	if(table->processNum == 0){ // Table is filled while scheduling; Only keys without layout can be packed.
+		rq->PIDbits = 32, rq->priorityBits = 32, rq->priorityBase = 0;
+		rq->packable = (rq->criteria != criteria_SJF && rq->criteria != criteria_AGING);
+		return;
+	}
+	int maxPID = 0, maxLeft = 0, minPriority = inf, maxPriority = -inf;
+	for(int i=0; i<table->processNum; i++){
+		maxPID = max2(maxPID, table->PID[i]), maxLeft = max2(maxLeft, table->CPUburstleft[i]);
+		minPriority = min2(minPriority, table->givenPriority[i]), maxPriority = max2(maxPriority, table->givenPriority[i]);
+	}
+	rq->PIDbits = bitLength(maxPID);
+	rq->priorityBase = minPriority;
+	rq->priorityBits = table->processNum > 0 ? bitLength((unsigned int)(maxPriority - minPriority)) : 0;
+	switch(rq->criteria){
+		case criteria_SJF: rq->packable = (bitLength(maxLeft) + rq->priorityBits + rq->PIDbits <= 64); break;
+		case criteria_AGING: rq->packable = false; break;
+		default: rq->packable = true;
+	}
+}
+
+// Packed key of table[index] by given criteria of queue. Smaller key means higher priority.
+specialized unsigned long long readyQueueKey(ReadyQueue *rq, int index, ProcessComparisonCriteria criteria){
+	ProcessTable *table = rq->table;
+	unsigned long long PID = (unsigned int)table->PID[index];
+	switch(criteria){
+		case criteria_FCFS: // (arrivalTime, PID)
+			return ((unsigned long long)(unsigned int)table->arrivalTime[index] << 32) | PID;
+		case criteria_SJF: // (CPUburstleft, givenPriority, PID)
+			return ((unsigned long long)table->CPUburstleft[index] << (rq->priorityBits + rq->PIDbits)) |
+				((unsigned long long)(unsigned int)(table->givenPriority[index] - rq->priorityBase) << rq->PIDbits) | PID;
+		case criteria_P: // (givenPriority, PID), sign bit flipped to keep order of negative values
+		case criteria_PDy:
+			return ((unsigned long long)((unsigned int)table->givenPriority[index] ^ 0x80000000u) << 32) | PID;
+		default:
+			return PID;
+	}
+}
+
+// Construct new ready queue
+ReadyQueue* newReadyQueue(int capacity, ProcessTable *table, ProcessComparisonCriteria criteria){
+	if(capacity <= 0) capacity = 16;
+	pthread_once(&argminKernelSelected, selectArgminKernel);
+	ReadyQueue *newRq = (ReadyQueue*)countedMalloc(sizeof(ReadyQueue));
+	newRq->heap = (int*)countedMalloc(sizeof(int) * capacity);
+	newRq->size = 0, newRq->capacity = capacity;
+	newRq->position = (int*)countedMalloc(sizeof(int) * capacity);
+	newRq->positionCapacity = capacity;
+	for(int i=0; i<capacity; i++) newRq->position[i] = -1;
+	newRq->table = table;
+	newRq->criteria = criteria;
+	setReadyQueuePacking(newRq);
+	newRq->flat = newRq->packable;
+	newRq->keys = newRq->packable ? (unsigned long long*)countedMalloc(sizeof(unsigned long long) * flatReadyQueueLimit) : NULL;
+	newRq->topPosition = -1;
+	return newRq;
+}
+
+// Delete ready queue itself
+void deleteReadyQueue(ReadyQueue *rq){
+	free(rq->heap);
+	free(rq->position);
+	free(rq->keys);
+	free(rq);
+}
+
+// Move element at given position up until heap property is satisfied. Criteria is the one of queue.
+specialized void readyQueueSiftUp(ReadyQueue *rq, int position, ProcessComparisonCriteria criteria){
+	int moving = rq->heap[position];
+	while(position > 0){
+		int parent = (position - 1) / 2;
+		if(!tableComparisonGT(rq->table, moving, rq->heap[parent], criteria)) break;
+		rq->heap[position] = rq->heap[parent];
+		rq->position[rq->heap[position]] = position;
+		position = parent;
+	} rq->heap[position] = moving;
+	rq->position[moving] = position;
+}
+
+// Move element at given position down until heap property is satisfied. Criteria is the one of queue.
+// Return number of levels descended.
+specialized int readyQueueSiftDown(ReadyQueue *rq, int position, ProcessComparisonCriteria criteria){
+	int moving = rq->heap[position], levels = 0;
+	while(true){
+		int child = position * 2 + 1;
+		if(child >= rq->size) break;
+		if(child + 1 < rq->size && tableComparisonGT(rq->table, rq->heap[child+1], rq->heap[child], criteria)) child++;
+		if(!tableComparisonGT(rq->table, rq->heap[child], moving, criteria)) break;
+		rq->heap[position] = rq->heap[child];
+		rq->position[rq->heap[position]] = position;
+		position = child, levels++;
+	} rq->heap[position] = moving;
+	rq->position[moving] = position;
+	return levels;
+}
+
+// Switch mode. Flat to heap when it grows over flatReadyQueueLimit, heap to flat when it shrinks under half of it.
+void readyQueueSetMode(ReadyQueue *rq, bool flat){
+	rq->flat = flat;
+	rq->topPosition = -1;
+	if(flat) for(int i=0; i<rq->size; i++) rq->keys[i] = readyQueueKey(rq, rq->heap[i], rq->criteria);
+	else for(int i = rq->size / 2 - 1; i >= 0; i--) readyQueueSiftDown(rq, i, rq->criteria);
+}
+
+// Restore order after the key of element at given position is modified.
+specialized void readyQueueUpdateAs(ReadyQueue *rq, int position, ProcessComparisonCriteria criteria){
+	if(rq->flat){
+		rq->keys[position] = readyQueueKey(rq, rq->heap[position], criteria);
+		rq->topPosition = -1;
+	}
+	else if(position > 0 && tableComparisonGT(rq->table, rq->heap[position], rq->heap[(position - 1) / 2], criteria))
+		readyQueueSiftUp(rq, position, criteria);
+	else readyQueueSiftDown(rq, position, criteria);
+}
+void readyQueueUpdate(ReadyQueue *rq, int position){readyQueueUpdateAs(rq, position, rq->criteria);}
+
+// Restore order after key of table[index] became higher priority(smaller) than before. Only sifts up.
+specialized void readyQueueDecreaseKeyAs(ReadyQueue *rq, int index, ProcessComparisonCriteria criteria){
+	int position = rq->position[index];
+	if(rq->flat){
+		rq->keys[position] = readyQueueKey(rq, index, criteria);
+		if(rq->topPosition != -1 && rq->keys[position] < rq->keys[rq->topPosition]) rq->topPosition = position;
+	}
+	else readyQueueSiftUp(rq, position, criteria);
+}
+
+// Whether table[index] is in queue
+bool readyQueueContains(ReadyQueue *rq, int index){
+	return index < rq->positionCapacity && rq->position[index] != -1;
+}
+
+// Rebuild whole queue in O(n). Used after keys of many elements are modified at once.
+void readyQueueRebuild(ReadyQueue *rq){
+	readyQueueSetMode(rq, rq->flat);
+}
+
+// Push new process index. Versions ending with As take criteria of queue from caller, so it can be constant.
+specialized void readyQueuePushAs(ReadyQueue *rq, int index, ProcessComparisonCriteria criteria){
+	if(rq->size == rq->capacity){
+		rq->capacity *= 2;
+		rq->heap = (int*)countedRealloc(rq->heap, sizeof(int) * rq->capacity);
+	}
+	if(index >= rq->positionCapacity){ // Table grew while scheduling trace
+		int capacity = max2(index + 1, rq->positionCapacity * 2);
+		rq->position = (int*)countedRealloc(rq->position, sizeof(int) * capacity);
+		for(int i=rq->positionCapacity; i<capacity; i++) rq->position[i] = -1;
+		rq->positionCapacity = capacity;
+	}
+	if(rq->flat && rq->size == flatReadyQueueLimit) readyQueueSetMode(rq, false);
+	rq->position[index] = rq->size;
+	rq->heap[rq->size++] = index;
+	if(rq->flat){
+		rq->keys[rq->size - 1] = readyQueueKey(rq, index, criteria);
+		if(rq->topPosition != -1 && rq->keys[rq->size - 1] < rq->keys[rq->topPosition]) rq->topPosition = rq->size - 1;
+	}
+	else readyQueueSiftUp(rq, rq->size - 1, criteria);
+}
+void readyQueuePush(ReadyQueue *rq, int index){readyQueuePushAs(rq, index, rq->criteria);}
+
+// Position of top process in heap array, or -1 if empty.
+int readyQueueTopPosition(ReadyQueue *rq){
+	if(rq->size == 0) return -1;
+	else if(!rq->flat) return 0;
+	if(rq->topPosition == -1) rq->topPosition = argminKeys(rq->keys, rq->size);
+	return rq->topPosition;
+}
+
+// Top process index, or -1 if empty.
+int readyQueueTop(ReadyQueue *rq){
+	return rq->size == 0 ? -1 : rq->heap[readyQueueTopPosition(rq)];
+}
+
+// Pop top process index. Caller should check emptiness before popping.
+// Only here keys scanned or heap levels descended are counted as pick cost, not in other updates of queue.
+specialized int readyQueuePopAs(ReadyQueue *rq, ProcessComparisonCriteria criteria){
+	if(rq->flat && rq->topPosition == -1) instrumentCount(CounterPickScanned, rq->size);
+	int position = readyQueueTopPosition(rq), popped = rq->heap[position];
+	rq->heap[position] = rq->heap[--rq->size];
+	rq->position[rq->heap[position]] = position, rq->position[popped] = -1;
+	if(rq->flat){
+		rq->keys[position] = rq->keys[rq->size];
+		rq->topPosition = -1;
+	}
+	else if(rq->size > 0){
+		int levels = readyQueueSiftDown(rq, 0, criteria);
+		instrumentCount(CounterPickScanned, levels);
+		if(rq->packable && rq->size < flatReadyQueueLimit / 2) readyQueueSetMode(rq, true);
+	} return popped;
+}
+int readyQueuePop(ReadyQueue *rq){return readyQueuePopAs(rq, rq->criteria);}
+
+// Remove table[index] from anywhere of queue. Return false if it is not in queue.
+specialized bool readyQueueRemoveAs(ReadyQueue *rq, int index, ProcessComparisonCriteria criteria){
+	if(!readyQueueContains(rq, index)) return false;
+	int position = rq->position[index];
+	rq->heap[position] = rq->heap[--rq->size];
+	rq->position[rq->heap[position]] = position, rq->position[index] = -1;
+	if(rq->flat){
+		rq->keys[position] = rq->keys[rq->size];
+		rq->topPosition = -1;
+	}
+	else if(position < rq->size) readyQueueUpdateAs(rq, position, criteria);
+	return true;
+}
+bool readyQueueRemove(ReadyQueue *rq, int index){return readyQueueRemoveAs(rq, index, rq->criteria);}
+
+// Lowest priority process index, or -1 if empty. Scans whole flat array, or leaves of heap since parent always has
+// higher priority than its children. Used by work stealing to take the process which would run last.
+int readyQueueBottom(ReadyQueue *rq){
+	if(rq->size == 0) return -1;
+	int bottom = rq->flat ? 0 : rq->size / 2;
+	for(int i=bottom+1; i<rq->size; i++){
+		if(rq->flat ? rq->keys[i] > rq->keys[bottom] : tableComparisonGT(rq->table, rq->heap[bottom], rq->heap[i], rq->criteria))
+			bottom = i;
+	} return rq->heap[bottom];
+}
+
+// Change given priority of table[index] which may be in queue, keeping order of queue.
+// Used by dynamically changing priorities, and can be used for nice-like adjustments.
+specialized void readyQueueSetPriorityAs(ReadyQueue *rq, int index, int priority, ProcessComparisonCriteria criteria){
+	int previous = rq->table->givenPriority[index];
+	rq->table->givenPriority[index] = priority;
+	if(criteria == criteria_SJF && rq->packable && (priority < rq->priorityBase ||
+		bitLength((unsigned int)(priority - rq->priorityBase)) > rq->priorityBits)){ // Out of packing layout
+		rq->packable = false;
+		if(rq->flat) readyQueueSetMode(rq, false);
+	}
+	if(!readyQueueContains(rq, index) || priority == previous) return;
+	else if(priority < previous) readyQueueDecreaseKeyAs(rq, index, criteria);
+	else readyQueueUpdateAs(rq, rq->position[index], criteria);
+}
+void readyQueueSetPriority(ReadyQueue *rq, int index, int priority){readyQueueSetPriorityAs(rq, index, priority, rq->criteria);}
+
+// Deque on ring buffer is kept in deque_save.c. Run queues of Round Robin and multilevel feedback queue,
+// and waiting queue, are deques whose features are process table indices themselves.
+#include "deque_save.c"
+#define indexFeature(index) ((void*)(long)(index))
+#define featureIndex(feature) ((int)(long)(feature))
+
+// --------------------------------------------------------------------------------------------------------------------
+// Data structure - Fair run queue
+
+// Run queue of completely fair scheduling. Each process has virtual runtime which grows by
+// (running time) * (weight of nice 0) / (weight of process) while it runs, and the one with the smallest runs next,
+// so every runnable process gets CPU time in proportion to its weight.
+// Runnable processes are kept in red-black tree ordered by (vruntime, PID), whose nodes are process table indices.
+// Links are arrays indexed by table index with nil = -1, and index -1 of them is valid storage as sentinel,
+// so tree operations never allocate per process. Leftmost node is cached; Pick is O(1), enqueue and dequeue are O(log n).
+#define fairNiceZeroWeight 1024
+#define fairVruntimeUnit 1024 // Virtual runtime of one time unit at nice 0
+
+// Weight of nice -20 ~ 19, each nice level is about 10% of CPU time. Given priority is used as nice value.
+const int fairNiceWeights[40] = {
+	88761, 71755, 56483, 46273, 36291, 29154, 23254, 18705, 14949, 11916,
+	9548, 7620, 6100, 4904, 3906, 3121, 2501, 1991, 1586, 1277,
+	1024, 820, 655, 526, 423, 335, 272, 215, 172, 137,
+	110, 87, 70, 56, 45, 36, 29, 23, 18, 15
+};
+
+// How enqueued process's virtual runtime is placed relative to minimum virtual runtime of queue
+//   FairEnqueueNew: Starts from minimum, so new process neither starves others nor is starved.
+//   FairEnqueueWakeup: Gets credit of at most half target latency for time it was sleeping on I/O.
+//   FairEnqueuePreempted: Kept as is.
+typedef enum {FairEnqueueNew, FairEnqueueWakeup, FairEnqueuePreempted} FairEnqueueKind;
+
+struct FairQueue__{
+	int *left, *right, *parent; // Index -1 is sentinel
+	bool *red;
+	long long *vruntime; // Kept while process is not in tree
+	int root, leftmost, size, capacity;
+	long long minVruntime, totalWeight; // Minimum never decreases; Total weight of processes in tree
+	int targetLatency, minGranularity, wakeupGranularity;
+	ProcessTable *table;
+}; typedef struct FairQueue__ FairQueue;
+
+// Weight of table[index]
+int fairWeightOf(ProcessTable *table, int index){
+	return fairNiceWeights[max2(-20, min2(19, table->givenPriority[index])) + 20];
+}
+
+// Resize all arrays to given capacity, keeping sentinel slots
+void resizeFairQueue(FairQueue *fq, int capacity){
+	#define resizeFairArray(array, type) fq->array = (type*)countedRealloc(fq->array == NULL ? NULL : fq->array - 1, sizeof(type) * (capacity + 1)) + 1
+	resizeFairArray(left, int); resizeFairArray(right, int); resizeFairArray(parent, int);
+	resizeFairArray(red, bool); resizeFairArray(vruntime, long long);
+	#undef resizeFairArray
+	fq->capacity = capacity;
+}
+
+// Construct new fair queue. Target latency is period in which every runnable process should run once,
+// unless it would make time slice shorter than minimum granularity. Wakeup granularity is how far running process
+// can be ahead of new or woken one before it is preempted(see fairQueueShouldPreempt).
+FairQueue* newFairQueue(int capacity, ProcessTable *table, int targetLatency, int minGranularity, int wakeupGranularity){
+	FairQueue *newFq = (FairQueue*)countedCalloc(1, sizeof(FairQueue));
+	resizeFairQueue(newFq, max2(capacity, 16));
+	newFq->red[-1] = false;
+	newFq->root = newFq->leftmost = -1;
+	newFq->size = 0;
+	newFq->minVruntime = 0, newFq->totalWeight = 0;
+	newFq->targetLatency = max2(1, targetLatency), newFq->minGranularity = max2(1, minGranularity);
+	newFq->wakeupGranularity = max2(0, wakeupGranularity);
+	newFq->table = table;
+	return newFq;
+}
+
+// Delete fair queue itself
+void deleteFairQueue(FairQueue *fq){
+	free(fq->left - 1); free(fq->right - 1); free(fq->parent - 1);
+	free(fq->red - 1); free(fq->vruntime - 1);
+	free(fq);
+}
+
+// Return true if table[i] runs before table[j]
+specialized bool fairQueueLess(FairQueue *fq, int i, int j){
+	instrumentCount(CounterComparisons, 1);
+	if(fq->vruntime[i] != fq->vruntime[j]) return fq->vruntime[i] < fq->vruntime[j];
+	else return fq->table->PID[i] < fq->table->PID[j];
+}
+
+// Rotations. Direction is where x goes down to.
+void fairQueueRotateLeft(FairQueue *fq, int x){
+	int y = fq->right[x];
+	fq->right[x] = fq->left[y];
+	if(fq->left[y] != -1) fq->parent[fq->left[y]] = x;
+	fq->parent[y] = fq->parent[x];
+	if(fq->parent[x] == -1) fq->root = y;
+	else if(x == fq->left[fq->parent[x]]) fq->left[fq->parent[x]] = y;
+	else fq->right[fq->parent[x]] = y;
+	fq->left[y] = x, fq->parent[x] = y;
+}
+void fairQueueRotateRight(FairQueue *fq, int x){
+	int y = fq->left[x];
+	fq->left[x] = fq->right[y];
+	if(fq->right[y] != -1) fq->parent[fq->right[y]] = x;
+	fq->parent[y] = fq->parent[x];
+	if(fq->parent[x] == -1) fq->root = y;
+	else if(x == fq->right[fq->parent[x]]) fq->right[fq->parent[x]] = y;
+	else fq->left[fq->parent[x]] = y;
+	fq->right[y] = x, fq->parent[x] = y;
+}
+
+// Insert table[index] with its current virtual runtime
+void fairQueueInsert(FairQueue *fq, int index){
+	int parent = -1, x = fq->root;
+	while(x != -1) parent = x, x = (fairQueueLess(fq, index, x) ? fq->left[x] : fq->right[x]);
+	fq->parent[index] = parent, fq->left[index] = fq->right[index] = -1, fq->red[index] = true;
+	if(parent == -1) fq->root = index;
+	else if(fairQueueLess(fq, index, parent)) fq->left[parent] = index;
+	else fq->right[parent] = index;
+	if(fq->leftmost == -1 || fairQueueLess(fq, index, fq->leftmost)) fq->leftmost = index;
+	
+	// Fix red parent with red child
+	int z = index;
+	while(fq->red[fq->parent[z]]){
+		int p = fq->parent[z], g = fq->parent[p];
+		bool parentIsLeft = (p == fq->left[g]);
+		int uncle = parentIsLeft ? fq->right[g] : fq->left[g];
+		if(fq->red[uncle]){
+			fq->red[p] = fq->red[uncle] = false, fq->red[g] = true;
+			z = g;
+			continue;
+		}
+		if(z == (parentIsLeft ? fq->right[p] : fq->left[p])){
+			z = p;
+			if(parentIsLeft) fairQueueRotateLeft(fq, z); else fairQueueRotateRight(fq, z);
+			p = fq->parent[z];
+		}
+		fq->red[p] = false, fq->red[g] = true;
+		if(parentIsLeft) fairQueueRotateRight(fq, g); else fairQueueRotateLeft(fq, g);
+	}
+	fq->red[fq->root] = false;
+}
+
+// Replace subtree u by subtree v. Parent of v is set even if v is nil, since deletion fix starts from there.
+void fairQueueTransplant(FairQueue *fq, int u, int v){
+	if(fq->parent[u] == -1) fq->root = v;
+	else if(u == fq->left[fq->parent[u]]) fq->left[fq->parent[u]] = v;
+	else fq->right[fq->parent[u]] = v;
+	fq->parent[v] = fq->parent[u];
+}
+
+// Leftmost node of subtree
+int fairQueueMinimum(FairQueue *fq, int x){
+	while(fq->left[x] != -1) x = fq->left[x];
+	return x;
+}
+
+// Remove table[index] from tree
+void fairQueueErase(FairQueue *fq, int index){
+	if(index == fq->leftmost) // Leftmost has no left child, so next one is in right subtree or is parent
+		fq->leftmost = (fq->right[index] != -1 ? fairQueueMinimum(fq, fq->right[index]) : fq->parent[index]);
+	int moved = index, x;
+	bool removedRed = fq->red[moved];
+	if(fq->left[index] == -1) x = fq->right[index], fairQueueTransplant(fq, index, x);
+	else if(fq->right[index] == -1) x = fq->left[index], fairQueueTransplant(fq, index, x);
+	else{
+		moved = fairQueueMinimum(fq, fq->right[index]), removedRed = fq->red[moved];
+		x = fq->right[moved];
+		if(fq->parent[moved] == index) fq->parent[x] = moved;
+		else{
+			fairQueueTransplant(fq, moved, x);
+			fq->right[moved] = fq->right[index], fq->parent[fq->right[moved]] = moved;
+		}
+		fairQueueTransplant(fq, index, moved);
+		fq->left[moved] = fq->left[index], fq->parent[fq->left[moved]] = moved;
+		fq->red[moved] = fq->red[index];
+	}
+	
+	// Removing black node leaves x with one extra black
+	if(!removedRed){
+		while(x != fq->root && !fq->red[x]){
+			int p = fq->parent[x];
+			bool isLeft = (x == fq->left[p]);
+			int sibling = isLeft ? fq->right[p] : fq->left[p];
+			if(fq->red[sibling]){
+				fq->red[sibling] = false, fq->red[p] = true;
+				if(isLeft) fairQueueRotateLeft(fq, p); else fairQueueRotateRight(fq, p);
+				sibling = isLeft ? fq->right[p] : fq->left[p];
+			}
+			int near = isLeft ? fq->left[sibling] : fq->right[sibling], far = isLeft ? fq->right[sibling] : fq->left[sibling];
+			if(!fq->red[near] && !fq->red[far]){
+				fq->red[sibling] = true;
+				x = p;
+				continue;
+			}
+			if(!fq->red[far]){
+				fq->red[near] = false, fq->red[sibling] = true;
+				if(isLeft) fairQueueRotateRight(fq, sibling); else fairQueueRotateLeft(fq, sibling);
+				sibling = isLeft ? fq->right[p] : fq->left[p];
+				far = isLeft ? fq->right[sibling] : fq->left[sibling];
+			}
+			fq->red[sibling] = fq->red[p], fq->red[p] = false, fq->red[far] = false;
+			if(isLeft) fairQueueRotateLeft(fq, p); else fairQueueRotateRight(fq, p);
+			x = fq->root;
+		}
+		fq->red[x] = false;
+	}
+	fq->red[-1] = false;
+}
+
+// Make table[index] runnable
+void fairQueueEnqueue(FairQueue *fq, int index, FairEnqueueKind kind){
+	if(index >= fq->capacity) resizeFairQueue(fq, max2(index + 1, fq->capacity * 2)); // Table grew while scheduling trace
+	if(kind == FairEnqueueNew) fq->vruntime[index] = fq->minVruntime;
+	else if(kind == FairEnqueueWakeup){
+		long long credited = fq->minVruntime - (long long)fq->targetLatency * fairVruntimeUnit / 2;
+		if(fq->vruntime[index] < credited) fq->vruntime[index] = credited;
+	}
+	fairQueueInsert(fq, index);
+	fq->size++, fq->totalWeight += fairWeightOf(fq->table, index);
+}
+
+// Pop process with the smallest virtual runtime. Caller should check emptiness before popping.
+int fairQueuePop(FairQueue *fq){
+	int popped = fq->leftmost;
+	fairQueueErase(fq, popped);
+	fq->size--, fq->totalWeight -= fairWeightOf(fq->table, popped);
+	if(fq->vruntime[popped] > fq->minVruntime) fq->minVruntime = fq->vruntime[popped];
+	return popped;
+}
+
+// Time slice of table[index] which was just popped: its share of scheduling period by weight, where period is
+// target latency, or stretched to give minimum granularity to each runnable process if there are too many of them.
+int fairQueueSlice(FairQueue *fq, int index){
+	long long runnable = fq->size + 1, weight = fairWeightOf(fq->table, index);
+	long long period = runnable * fq->minGranularity > fq->targetLatency ? runnable * fq->minGranularity : fq->targetLatency;
+	long long slice = period * weight / (fq->totalWeight + weight);
+	return slice < fq->minGranularity ? fq->minGranularity : (slice > inf ? inf : (int)slice);
+}
+
+// Charge running time to virtual runtime of table[index]
+void fairQueueCharge(FairQueue *fq, int index, int duration){
+	fq->vruntime[index] += (long long)duration * fairVruntimeUnit * fairNiceZeroWeight / fairWeightOf(fq->table, index);
+}
+
+// Whether new or woken table[waker] should preempt running table[current]: only if current's virtual runtime is ahead
+// by more than wakeup granularity in waker's virtual time, so that wakeups don't switch processes too often.
+bool fairQueueShouldPreempt(FairQueue *fq, int current, int waker){
+	long long granularity = (long long)fq->wakeupGranularity * fairVruntimeUnit * fairNiceZeroWeight / fairWeightOf(fq->table, waker);
+	return fq->vruntime[current] - fq->vruntime[waker] > granularity;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Data structure - Event queue
+
+// Min heap of future events, ordered by (time, pushed order). Arrivals are not pushed here since
+// process table is already sorted by arrival time; scheduler takes whichever of both comes first.
+struct Event__{
+	int time;
+	int target; // Device index for I/O completion
+	unsigned long long order;
+}; typedef struct Event__ Event;
+struct EventQueue__{
+	Event *heap;
+	int size, capacity;
+	unsigned long long pushed;
+}; typedef struct EventQueue__ EventQueue;
+
+// Construct new event queue
+EventQueue* newEventQueue(int capacity){
+	if(capacity <= 0) capacity = 16;
+	EventQueue *newEq = (EventQueue*)countedMalloc(sizeof(EventQueue));
+	newEq->heap = (Event*)countedMalloc(sizeof(Event) * capacity);
+	newEq->size = 0, newEq->capacity = capacity, newEq->pushed = 0;
+	return newEq;
+}
+
+// Delete event queue itself
+void deleteEventQueue(EventQueue *eq){
+	free(eq->heap);
+	free(eq);
+}
+
+// Return true if e1 happens before e2
+bool eventEarlier(Event *e1, Event *e2){
+	return e1->time != e2->time ? e1->time < e2->time : e1->order < e2->order;
+}
+
+// Push new event
+void eventQueuePush(EventQueue *eq, int time, int target){
+	if(eq->size == eq->capacity){
+		eq->capacity *= 2;
+		eq->heap = (Event*)countedRealloc(eq->heap, sizeof(Event) * eq->capacity);
+	}
+	Event newEvent = {time, target, eq->pushed++};
+	int position = eq->size++;
+	while(position > 0 && eventEarlier(&newEvent, eq->heap + (position - 1) / 2)){
+		eq->heap[position] = eq->heap[(position - 1) / 2];
+		position = (position - 1) / 2;
+	} eq->heap[position] = newEvent;
+}
+
+// Time of earliest event, or inf if empty.
+int eventQueueNextTime(EventQueue *eq){
+	return eq->size == 0 ? inf : eq->heap[0].time;
+}
+
+// Pop earliest event. Caller should check emptiness before popping.
+Event eventQueuePop(EventQueue *eq){
+	Event popped = eq->heap[0], last = eq->heap[--eq->size];
+	int position = 0;
+	while(2 * position + 1 < eq->size){
+		int child = 2 * position + 1;
+		if(child + 1 < eq->size && eventEarlier(eq->heap + child + 1, eq->heap + child)) child++;
+		if(!eventEarlier(eq->heap + child, &last)) break;
+		eq->heap[position] = eq->heap[child];
+		position = child;
+	}
+	if(eq->size > 0) eq->heap[position] = last;
+	return popped;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// I/O devices
+
+// Device serves one process at a time, and other requesting processes wait in its waiting queue (FIFO).
+// Completion of current service is pushed into event queue with device index as target.
+// I/O burst k of process goes to device (PID + k) % deviceNum, so bursts of one process are spread over devices.
+struct IODevice__{
+	int serving; // Table index, or -1 if idle
+	Deque *waitingQueue;
+}; typedef struct IODevice__ IODevice;
+
+// Construct deviceNum idle devices
+IODevice* newIODevices(int deviceNum){
+	IODevice *devices = (IODevice*)countedMalloc(sizeof(IODevice) * deviceNum);
+	for(int d=0; d<deviceNum; d++) devices[d].serving = -1, devices[d].waitingQueue = newDeque(0, "waiting queue");
+	return devices;
+}
+
+// Delete devices
+void deleteIODevices(IODevice *devices, int deviceNum){
+	for(int d=0; d<deviceNum; d++) deleteDeque(devices[d].waitingQueue, false);
+	free(devices);
+}
+
+// Table[index] finished its CPU burst and requests next I/O burst at given timestamp. Return device index.
+int requestIO(IODevice *devices, int deviceNum, EventQueue *events, ProcessTable *table, int index, int timestamp){
+	int d = (int)(((long long)table->PID[index] + table->IOdone[index]) % deviceNum);
+	if(devices[d].serving == -1){
+		devices[d].serving = index;
+		eventQueuePush(events, timestamp + table->IOburst[index], d);
+	}
+	else pushBack(devices[d].waitingQueue, indexFeature(index));
+	return d;
+}
+
+// Complete earliest I/O in event queue and start next waiting one on that device.
+// Return table index of process whose I/O burst is finished; its next CPU burst is set.
+int completeIO(IODevice *devices, EventQueue *events, ProcessTable *table){
+	Event completed = eventQueuePop(events);
+	IODevice *device = devices + completed.target;
+	int done = device->serving;
+	table->IOdone[done]++;
+	table->burstBoundary[done] = nextBurstBoundary(table, done);
+	if(device->waitingQueue->currentSize > 0){
+		device->serving = featureIndex(popFront(device->waitingQueue));
+		eventQueuePush(events, completed.time + table->IOburst[device->serving], completed.target);
+	}
+	else device->serving = -1;
+	return done;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Schedule context
+
+// Every state which single scheduling run reads or modifies, except processes and timeline.
+// Each run owns its context, so multiple runs can be done in parallel.
+typedef enum {LoadBalancingGlobal, LoadBalancingStealing, LoadBalancingAffinity} LoadBalancing;
+const char *LoadBalancingNames[3] = {"global queue", "work stealing", "affinity"};
+#define defaultCFSTargetLatency 24
+#define defaultCFSMinGranularity 3
+#define defaultCFSWakeupGranularity 4
+struct ScheduleContext__{
+	int RRQuantumTime;
+	int CFSTargetLatency, CFSMinGranularity, CFSWakeupGranularity; // Used only by completely fair scheduling, see Fair run queue
+	AgingConfig aging; // Used only by aging
+	int IODeviceNum;
+	int coreNum, migrationCost; // Used only by ScheduleSMP
+	LoadBalancing balancing;
+	RandomStream random; // For dynamically changing priorities
+	Verbosity verbosity;
+	TimelineFormat format; // Used by runPolicy
+	FILE *output; // Logs and Gantt chart are written here
+}; typedef struct ScheduleContext__ ScheduleContext;
+
+// Create new one
+ScheduleContext newScheduleContext(int RRQuantumTime, int IODeviceNum, unsigned long long randomSeed, unsigned long long randomStreamID, 
+		Verbosity verbosity, FILE *output){
+	ScheduleContext newCreatedOne;
+	newCreatedOne.RRQuantumTime = RRQuantumTime;
+	newCreatedOne.CFSTargetLatency = defaultCFSTargetLatency, newCreatedOne.CFSMinGranularity = defaultCFSMinGranularity;
+	newCreatedOne.CFSWakeupGranularity = defaultCFSWakeupGranularity;
+	newCreatedOne.aging = defaultAgingConfig;
+	newCreatedOne.IODeviceNum = max2(1, IODeviceNum);
+	newCreatedOne.coreNum = 1, newCreatedOne.migrationCost = 0;
+	newCreatedOne.balancing = LoadBalancingGlobal;
+	seedRandomStream(&newCreatedOne.random, randomSeed, randomStreamID);
+	newCreatedOne.verbosity = verbosity;
+	newCreatedOne.format = TimelineFormatText;
+	newCreatedOne.output = output;
+	return newCreatedOne;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Streaming statistics
+
+// Single metric updated one value at a time: 64-bit sum, mean and variance by Welford's method, and
+// log-linear histogram for percentiles. Values below 2^(subBits+1) have exact buckets, and every bigger value
+// falls into bucket of width 2^e with relative error below 2^-subBits, so memory is fixed regardless of value count.
+#define metricSubBucketBits 5
+#define metricSubBuckets (1 << metricSubBucketBits)
+#define metricBucketNum ((32 - metricSubBucketBits) * metricSubBuckets)
+struct RunningMetric__{
+	long long count, sum;
+	double mean, m2; // m2 is sum of squared differences from mean
+	int minValue, maxValue;
+	long long histogram[metricBucketNum];
+}; typedef struct RunningMetric__ RunningMetric;
+
+// Reset metric to empty one
+void initRunningMetric(RunningMetric *m){
+	memset(m, 0, sizeof(RunningMetric));
+	m->minValue = inf, m->maxValue = -inf;
+}
+
+// Histogram bucket of non-negative value, and the smallest value of the bucket
+int metricBucketOf(int value){
+	if(value < 2 * metricSubBuckets) return value;
+	int e = bitLength((unsigned long long)value) - metricSubBucketBits - 1;
+	return e * metricSubBuckets + (value >> e);
+}
+int metricBucketLowest(int bucket){
+	if(bucket < 2 * metricSubBuckets) return bucket;
+	int e = bucket / metricSubBuckets - 1;
+	return (bucket - e * metricSubBuckets) << e;
+}
+
+// Add single value
+void addRunningMetric(RunningMetric *m, int value){
+	m->count++;
+	m->sum += value;
+	double delta = value - m->mean;
+	m->mean += delta / m->count;
+	m->m2 += delta * (value - m->mean);
+	m->minValue = min2(m->minValue, value), m->maxValue = max2(m->maxValue, value);
+	m->histogram[metricBucketOf(max2(value, 0))]++;
+}
+
+// Merge src into dst, as if all values of src were added to dst
+void mergeRunningMetric(RunningMetric *dst, const RunningMetric *src){
+	if(src->count == 0) return;
+	long long count = dst->count + src->count;
+	double delta = src->mean - dst->mean;
+	dst->m2 += src->m2 + delta * delta * ((double)dst->count * src->count / count);
+	dst->mean += delta * src->count / count;
+	dst->count = count, dst->sum += src->sum;
+	dst->minValue = min2(dst->minValue, src->minValue), dst->maxValue = max2(dst->maxValue, src->maxValue);
+	for(int i=0; i<metricBucketNum; i++) dst->histogram[i] += src->histogram[i];
+}
+
+// Population standard deviation
+double runningMetricStddev(const RunningMetric *m){
+	return m->count > 0 ? sqrt(m->m2 / m->count) : 0.0;
+}
+
+// Approximate q-quantile; middle of the bucket which contains ceil(q * count)-th smallest value.
+// Exact minimum if q <= 0, and exact maximum if q >= 1.
+int runningMetricPercentile(const RunningMetric *m, double q){
+	if(m->count == 0) return 0;
+	else if(q <= 0) return m->minValue;
+	else if(q >= 1) return m->maxValue;
+	long long rank = (long long)ceil(q * m->count), seen = 0;
+	if(rank < 1) rank = 1;
+	for(int i=0; i<metricBucketNum; i++){
+		seen += m->histogram[i];
+		if(seen < rank) continue;
+		int lowest = metricBucketLowest(i), width = metricBucketLowest(i + 1) - lowest;
+		return max2(m->minValue, min2(m->maxValue, lowest + (width - 1) / 2));
+	} return m->maxValue;
+}
+
+// Statistics of single timeline. Updated by doJobFor as processes run and finish.
+struct ScheduleStatistics__{
+	int finishedNum;
+	RunningMetric turnaround, waiting, response; // Waiting doesn't include I/O bursts
+	long long busyTime; // Idle and context switching are not counted as busy
+	long long contextSwitches;
+	long long dispatches; // Number of doJobFor calls
+}; typedef struct ScheduleStatistics__ ScheduleStatistics;
+
+// Reset statistics
+void initScheduleStatistics(ScheduleStatistics *stats){
+	stats->finishedNum = 0;
+	initRunningMetric(&stats->turnaround); initRunningMetric(&stats->waiting); initRunningMetric(&stats->response);
+	stats->busyTime = 0, stats->contextSwitches = 0, stats->dispatches = 0;
+}
+
+// Merge src into dst
+void mergeScheduleStatistics(ScheduleStatistics *dst, const ScheduleStatistics *src){
+	dst->finishedNum += src->finishedNum;
+	mergeRunningMetric(&dst->turnaround, &src->turnaround);
+	mergeRunningMetric(&dst->waiting, &src->waiting);
+	mergeRunningMetric(&dst->response, &src->response);
+	dst->busyTime += src->busyTime, dst->contextSwitches += src->contextSwitches, dst->dispatches += src->dispatches;
+}
+
+// Reflect finished table[index]
+void recordFinishedProcess(ScheduleStatistics *stats, ProcessTable *table, int index){
+	int turnaround = table->finishedTime[index] - table->arrivalTime[index];
+	stats->finishedNum++;
+	addRunningMetric(&stats->turnaround, turnaround);
+	addRunningMetric(&stats->waiting, (int)(turnaround - table->CPUburst[index] - (long long)table->IOcount[index] * table->IOburst[index]));
+	addRunningMetric(&stats->response, table->firstRunTime[index] - table->arrivalTime[index]);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Timeline structure
+
+// Timeline
+#define initialTimelineCapacity 64
+struct Timeline__{
+	
+	// Nonarray attributes
+	int timelinesize, timelinecapacity, timestamp;
+	int processNum, contextswitchingcost;
+	ProcessTable *table; // Used while scheduling. After it, finished processes are read from it if ownsTable.
+	ScheduleContext *context;
+	
+	// Result of scheduling: finishedOrder[i] is table index of i-th finished process.
+	// ownedWorkload is base of table which is created by scheduling method itself, such as ScheduleGeneral.
+	int *finishedOrder;
+	bool ownsTable;
+	ProcessTable *ownedWorkload;
+	
+	// Timerelated attributes: [(usedProcessesPID[i], interval[i][0], interval[i][1]), ...]
+	// For all i, <PID = usedProcessesPID[i]> process did job in time interval [interval[i][0], interval[i][1])
+	// Both arrays are heap allocated and grow together when timelinesize reaches timelinecapacity.
+	int (*interval)[2];
+	int *usedProcessesPID; // This can be null since CPU can kill time without doing any jobs
+	bool keepSegments; // If false, only the latest segment is kept (streaming trace)
+	
+	// Open segment [openStart, timestamp) of openPID. Consecutive jobs of same PID are coalesced here, and
+	// written to arrays only when different PID comes or closeTimeline is called.
+	int openPID, openStart;
+	
+	// Statistics, updated while scheduling
+	ScheduleStatistics stats;
+#ifdef useInstrumentation
+	Instrumentation instrumentation;
+#endif
+	
+}; typedef struct Timeline__ Timeline;
+
+// Default quantum time and number of I/O devices which new contexts are created with
+static int globalRRQuantumTime = 10;
+static int globalIODeviceNum = 1;
+static int globalCFSTargetLatency = defaultCFSTargetLatency, globalCFSMinGranularity = defaultCFSMinGranularity;
+static int globalCFSWakeupGranularity = defaultCFSWakeupGranularity;
+static AgingConfig globalAgingConfig = {AgingFormulaExponential, 0.75, 0.28768207245178090}; // Same as defaultAgingConfig
+
+// Copy policy parameters above into context
+void applyGlobalPolicyConfig(ScheduleContext *context){
+	context->CFSTargetLatency = globalCFSTargetLatency, context->CFSMinGranularity = globalCFSMinGranularity;
+	context->CFSWakeupGranularity = globalCFSWakeupGranularity;
+	context->aging = globalAgingConfig;
+}
+
+// Multi-core configuration which schedulingTests uses for SMP runs
+static int globalCoreNum = 1, globalMigrationCost = 0;
+static LoadBalancing globalLoadBalancing = LoadBalancingGlobal;
+
+// Output configuration which main and schedulingTests use
+static Verbosity globalVerbosity = VerbosityNormal;
+static TimelineFormat globalTimelineFormat = TimelineFormatText;
+
+// Create new one
+Timeline* newTimeline(int processNum, int contextswitchingcost, ScheduleContext *context){
+	Timeline *newCreatedOne = (Timeline*)countedMalloc(sizeof(Timeline));
+	newCreatedOne->timelinesize = 0;
+	newCreatedOne->timelinecapacity = initialTimelineCapacity;
+	newCreatedOne->timestamp = 0;
+	newCreatedOne->table = NULL;
+	newCreatedOne->finishedOrder = NULL;
+	newCreatedOne->ownsTable = false, newCreatedOne->ownedWorkload = NULL;
+	newCreatedOne->processNum = processNum;
+	newCreatedOne->contextswitchingcost = contextswitchingcost;
+	newCreatedOne->context = context;
+	newCreatedOne->interval = (int(*)[2])countedMalloc(sizeof(int[2]) * initialTimelineCapacity);
+	newCreatedOne->usedProcessesPID = (int*)countedMalloc(sizeof(int) * initialTimelineCapacity);
+	newCreatedOne->keepSegments = true;
+	newCreatedOne->openPID = -1, newCreatedOne->openStart = 0;
+	initScheduleStatistics(&newCreatedOne->stats);
+#ifdef useInstrumentation
+	memset(&newCreatedOne->instrumentation, 0, sizeof(Instrumentation));
+#endif
+	return newCreatedOne;
+}
+
+// Delete timeline itself with results of scheduling.
+void deleteTimeline(Timeline *timeline){
+	if(timeline->ownsTable) deleteProcessTable(timeline->table);
+	if(timeline->ownedWorkload != NULL) deleteProcessTable(timeline->ownedWorkload);
+	free(timeline->finishedOrder);
+	free(timeline->interval);
+	free(timeline->usedProcessesPID);
+	free(timeline);
+}
+
+// Make sure there is a space for one more segment
+void reserveTimelineSegment(Timeline *timeline){
+	if(timeline->timelinesize < timeline->timelinecapacity) return;
+	timeline->timelinecapacity *= 2;
+	timeline->interval = (int(*)[2])countedRealloc(timeline->interval, sizeof(int[2]) * timeline->timelinecapacity);
+	timeline->usedProcessesPID = (int*)countedRealloc(timeline->usedProcessesPID, sizeof(int) * timeline->timelinecapacity);
+	if(timeline->interval == NULL || timeline->usedProcessesPID == NULL){
+		printf("[Error] Failed to grow timeline to %d segments\n", timeline->timelinecapacity);
+		exit(-1);
+	}
+}
+
+// Write open segment into arrays if it is not empty, and open new one of given PID from current timestamp
+void closeSegment(Timeline *timeline, int nextPID){
+	if(timeline->openStart < timeline->timestamp){
+		if(!timeline->keepSegments) timeline->timelinesize = 0; // Keep only the latest one
+		reserveTimelineSegment(timeline);
+		timeline->usedProcessesPID[timeline->timelinesize] = timeline->openPID;
+		timeline->interval[timeline->timelinesize][0] = timeline->openStart;
+		timeline->interval[timeline->timelinesize][1] = timeline->timestamp;
+		timeline->timelinesize++;
+		instrumentCount(CounterSegmentsAppended, 1);
+	}
+	timeline->openPID = nextPID, timeline->openStart = timeline->timestamp;
+}
+
+// Write open segment so segment arrays reflect whole timeline. Scheduler calls this when scheduling is done.
+void closeTimeline(Timeline *timeline){
+	closeSegment(timeline, timeline->openPID);
+}
+
+// Result of doJobFor. Negative values are errors, and timeline is not modified in that case.
+typedef enum {JobInvalidDuration = -2, JobBurnedOut = -1, JobDone = 0, JobClamped = 1} JobStatus;
+
+// Make job with process table[index]. If given interval is bigger than given process's length then make interval lower
+// Parameter 'index' can be -1 if we intended to CPU kills time
+JobStatus doJobFor(Timeline *timeline, int index, int duration){
+	ProcessTable *table = timeline->table;
+	JobStatus status = JobDone;
+	
+	// Validation; Both rare cases are found by single comparison in common case
+	if(duration <= 0 || (index != -1 && table->CPUburstleft[index] < duration)){
+		if(duration <= 0) return JobInvalidDuration;
+		else if(table->CPUburstleft[index] == 0) return JobBurnedOut;
+		duration = table->CPUburstleft[index], status = JobClamped;
+	}
+	timeline->stats.dispatches++;
+	
+	// Timeline modification. Same PID as open segment only moves timestamp.
+	int PID = (index == -1 ? -1 : table->PID[index]);
+	if(PID != timeline->openPID){
+		if(PID != -1 && timeline->openPID != -1){
+			// Previous process and current processes are different and not null -> Add context switching cost
+			timeline->stats.contextSwitches++;
+			if(timeline->contextswitchingcost > 0){
+				closeSegment(timeline, -1);
+				timeline->timestamp += timeline->contextswitchingcost;
+				instrumentCount(CounterSwitchSegments, 1);
+			}
+		}
+		closeSegment(timeline, PID);
+	}
+	else instrumentCount(CounterSegmentsCoalesced, 1);
+	timeline->timestamp += duration;
+	
+	// Process modification
+	if(index != -1){
+		timeline->stats.busyTime += duration;
+		if(table->firstRunTime[index] == -1) table->firstRunTime[index] = timeline->timestamp - duration;
+		table->CPUburstleft[index] -= duration;
+		if(table->refreshesAgingKeys) table->agingKey[index] = agingKeyOf(&table->aging, table->arrivalTime[index], table->CPUburstleft[index]);
+		if(table->CPUburstleft[index] == 0){
+			table->finishedTime[index] = timeline->timestamp;
+			recordFinishedProcess(&timeline->stats, table, index);
+			if(table->IOburst[index] != 0 && table->IOcount[index] == 0 && timeline->context->verbosity >= VerbosityNormal) fprintf(timeline->context->output, "[Random I/O] Random I/O performing from process #%d\n", PID);
+		}
+	}
+	return status;
+}
+
+// doJobFor for schedulers. Warning is written for clamped duration, and errors stop the program.
+void runJob(Timeline *timeline, int index, int duration){
+	instrumentTimerBegin(dispatch);
+	JobStatus status = doJobFor(timeline, index, duration);
+	instrumentTimerEnd(dispatch, TimerDispatch);
+	if(status == JobDone) return;
+	else if(status == JobClamped){
+		fprintf(timeline->context->output, "[Warning] Given duration(%d) is larger than process's CPU burst left, automatically fixed.\n",
+			duration);
+		return;
+	}
+	else if(status == JobInvalidDuration) printf("[Error] Invalid duration interval(%d) got in function doJobFor\n", duration);
+	else{
+		Process burned = processFromTable(timeline->table, index);
+		printf("[Error] Given "); reprSingleProcess(&burned, ProcessRepresentMinimal); 
+		printf(" is already burned out in function doJobFor\n");
+	} exit(-1);
+}
+
+// Context switching cost which doJobFor would add before job of table[index], so limits can be counted from its end
+int pendingSwitchCost(Timeline *timeline, int index){
+	int PID = timeline->table->PID[index];
+	return (PID != timeline->openPID && timeline->openPID != -1) ? timeline->contextswitchingcost : 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Naive scheduling
+
+// If true, ticking criterias jump directly to the next event instead of doing 1-unit jobs.
+static bool globalEventDrivenTicking = true;
+
+// For ticking criterias: Number of time units table[running] can keep going before table[rival] overtakes it.
+// Only running process's CPUburstleft changes while it runs and aging keys don't depend on timestamp,
+// so the crossover is solved from key(running) < key(rival), which is (1 + left) > threshold where threshold is
+// exp(arrival * arrivalWeight - key(rival)) with exponential formula, and arrival * arrivalWeight - key(rival) with linear one.
+// Result is corrected with compareAgingKeys, so it is exactly same as doing 1-unit jobs. Returned value is in [1, limit].
+int agingCrossoverDuration(ProcessTable *table, int running, int rival, int limit){
+	if(rival == -1 || limit <= 1) return max2(1, limit);
+	const AgingConfig *aging = &table->aging;
+	int left = table->CPUburstleft[running], arrival = table->arrivalTime[running];
+	double rivalKey = table->agingKey[rival];
+	double exponent = aging->arrivalWeight * arrival - rivalKey;
+	double threshold = (aging->formula == AgingFormulaExponential ? exp(exponent) : exponent);
+	double estimated = ceil((double)left + 1.0 - threshold);
+	int duration = estimated != estimated || estimated > limit ? limit : (estimated < 1 ? 1 : (int)estimated);
+	
+	// Correction: running process should be picked at the start of every unit in [0, duration).
+	#define runningStillPicked(afterDone) \
+		(compareAgingKeys(agingKeyOf(aging, arrival, left - (afterDone)), rivalKey) < 0 || \
+		(compareAgingKeys(agingKeyOf(aging, arrival, left - (afterDone)), rivalKey) == 0 && table->PID[running] < table->PID[rival]))
+	while(duration > 1 && !runningStillPicked(duration - 1)) duration--;
+	while(duration < limit && runningStillPicked(duration)) duration++;
+	#undef runningStillPicked
+	return duration;
+}
+
+// Multilevel feedback queue: Level l has quantum time (RR quantum time << l), and last level is FCFS.
+// New processes enter level 0. Process which used up its quantum goes down one level,
+// and process running on level > 0 is preempted when new process comes.
+#define MLFQLevels 3
+
+// Where scheduling takes arrivals from.
+//   Array: Processes are already in process table sorted by arrival, and table index i arrives i-th.
+//   Trace: Processes are read from trace when simulation clock reaches their arrival, into free slots of table.
+//          Slot of finished process is reused, so table size is bounded by number of processes alive at once.
+struct ArrivalSource__{
+	ProcessTable *table;
+	int admitted; // Number of processes came so far
+	TraceReader *trace; // NULL for array source
+	Process pending; bool hasPending; // Next process read from trace
+	int *freeSlots; int freeNum;
+}; typedef struct ArrivalSource__ ArrivalSource;
+
+// Construct sources. Trace source creates its own empty table.
+ArrivalSource arraySource(ProcessTable *table){
+	ArrivalSource source = {.table = table, .admitted = 0, .trace = NULL, .hasPending = false, .freeSlots = NULL, .freeNum = 0};
+	return source;
+}
+ArrivalSource traceSource(TraceReader *trace){
+	ArrivalSource source = {.table = newProcessTable(NULL, 0), .admitted = 0, .trace = trace, .freeSlots = NULL, .freeNum = 0};
+	source.hasPending = traceReaderNext(trace, &source.pending);
+	return source;
+}
+
+// Arrival time of next process, or inf if all came.
+int arrivalNextTime(ArrivalSource *source){
+	if(source->trace == NULL) return source->admitted < source->table->processNum ? source->table->arrivalTime[source->admitted] : inf;
+	else return source->hasPending ? source->pending.arrivalTime : inf;
+}
+
+// Take next process and return its table index. Table can grow here.
+int arrivalAdmit(ArrivalSource *source){
+	source->admitted++;
+	if(source->trace == NULL) return source->admitted - 1;
+	ProcessTable *table = source->table;
+	int index;
+	if(source->freeNum > 0) index = source->freeSlots[--source->freeNum];
+	else{
+		if(table->processNum == table->capacity){
+			resizeProcessTable(table, max2(16, table->capacity * 2));
+			source->freeSlots = (int*)countedRealloc(source->freeSlots, sizeof(int) * table->capacity);
+		}
+		index = table->processNum++;
+	}
+	setTableProcess(table, index, &source->pending);
+	source->hasPending = traceReaderNext(source->trace, &source->pending);
+	return index;
+}
+
+// Finished process doesn't need its slot anymore
+void arrivalRelease(ArrivalSource *source, int index){
+	if(source->trace != NULL) source->freeSlots[source->freeNum++] = index;
+}
+
+// Scheduling loop shared by ScheduleGeneral and ScheduleTrace. Finished indices are recorded in finishedOrder if not NULL.
+// Arrived indices are pushed into ready queue (or level 0 run queue for RR and MLFQ, fair run queue for CFS).
+// Process which finished CPU burst but not whole CPU burst requests I/O to a device,
+// and comes back to ready queue (or its own level) when I/O completion event happens.
+specialized void scheduleLoop(ArrivalSource *source, Timeline *timeline, bool preemptive, ProcessComparisonCriteria criteria, int *finishedOrder){
+	ScheduleContext *context = timeline->context;
+	FILE *out = context->output;
+	ProcessTable *table = source->table;
+	timeline->table = table;
+	table->refreshesAgingKeys = (criteria == criteria_AGING);
+	if(criteria == criteria_AGING) setProcessTableAging(table, &context->aging);
+	instrumentAttach(&timeline->instrumentation);
+	bool usesRunQueues = (criteria == criteria_RR || criteria == criteria_MLFQ), usesFairQueue = (criteria == criteria_CFS);
+	int levelNum = (criteria == criteria_MLFQ ? MLFQLevels : 1);
+	ReadyQueue *readyQueue = usesRunQueues || usesFairQueue ? NULL : newReadyQueue(table->capacity, table, criteria);
+	FairQueue *fairQueue = usesFairQueue ? newFairQueue(table->capacity, table, 
+		context->CFSTargetLatency, context->CFSMinGranularity, context->CFSWakeupGranularity) : NULL;
+	int fairCurrent = -1, fairSliceLeft = 0; // CFS process which stopped only to check wakeup preemption, and rest of its slice
+	bool fairPreempting = false;
+	Deque *runQueues[MLFQLevels];
+	for(int l=0; l<levelNum; l++) runQueues[l] = usesRunQueues ? newDeque(0, "run queue") : NULL;
+	int requeued = -1, requeuedLevel = 0; // Preempted process is put back after processes came meanwhile
+	int levelCapacity = table->capacity;
+	int *level = (criteria == criteria_MLFQ ? (int*)countedCalloc(max2(levelCapacity, 1), sizeof(int)) : NULL);
+	EventQueue *events = newEventQueue(context->IODeviceNum);
+	IODevice *devices = newIODevices(context->IODeviceNum);
+	int finished = 0;
+	while(finished < source->admitted || arrivalNextTime(source) != inf){
+		
+		// Take processes until all processes come
+		while(arrivalNextTime(source) <= timeline->timestamp){
+			int arrived = arrivalAdmit(source);
+			if(level != NULL){
+				if(table->capacity > levelCapacity){
+					level = (int*)countedRealloc(level, sizeof(int) * table->capacity);
+					levelCapacity = table->capacity;
+				} level[arrived] = 0;
+			}
+			if(usesRunQueues) pushBack(runQueues[0], indexFeature(arrived));
+			else if(usesFairQueue){
+				fairQueueEnqueue(fairQueue, arrived, FairEnqueueNew);
+				if(fairCurrent != -1 && fairQueueShouldPreempt(fairQueue, fairCurrent, arrived)) fairPreempting = true;
+			}
+			else readyQueuePushAs(readyQueue, arrived, criteria);
+		}
+		while(eventQueueNextTime(events) <= timeline->timestamp){
+			int returned = completeIO(devices, events, table);
+			if(context->verbosity >= VerbosityDebug) fprintf(out, "Process #%d finished I/O burst\n", table->PID[returned]);
+			if(usesRunQueues) pushBack(runQueues[level == NULL ? 0 : level[returned]], indexFeature(returned));
+			else if(usesFairQueue){
+				fairQueueEnqueue(fairQueue, returned, FairEnqueueWakeup);
+				if(fairCurrent != -1 && fairQueueShouldPreempt(fairQueue, fairCurrent, returned)) fairPreempting = true;
+			}
+			else readyQueuePushAs(readyQueue, returned, criteria);
+		}
+		if(requeued != -1){
+			pushBack(runQueues[requeuedLevel], indexFeature(requeued));
+			requeued = -1;
+		}
+		if(fairPreempting){
+			instrumentCount(CounterRequeues, 1);
+			fairQueueEnqueue(fairQueue, fairCurrent, FairEnqueuePreempted);
+			fairCurrent = -1, fairPreempting = false;
+		}
+		
+		// Now we should check for ready queue
+		int next_come = min2(arrivalNextTime(source), eventQueueNextTime(events));
+		int readyNum = 0, currentLevel = 0;
+		if(usesRunQueues){
+			for(int l=0; l<levelNum; l++) readyNum += runQueues[l]->currentSize;
+			while(currentLevel < levelNum - 1 && runQueues[currentLevel]->currentSize == 0) currentLevel++;
+		}
+		else readyNum = (usesFairQueue ? fairQueue->size + (fairCurrent != -1) : readyQueue->size);
+		if(readyNum == 0){ // Nothing to do; Just wait until next process comes.
+			if(next_come == inf){
+				printf("[Error] Something wrong happened in ScheduleGeneral (%s), all processes done but loop is not ended.\n",
+					ProcessComparisonNames[criteria]);
+				exit(-1);
+			}
+			runJob(timeline, -1, next_come - timeline->timestamp);
+			continue;
+		}
+		
+		if(criteria == criteria_PDy){ // Dynamically changing priorities
+			int randomChangingPosition = randomRange(&context->random, 0, readyQueue->size - 1);
+			int changing = readyQueue->heap[randomChangingPosition];
+			int currentPriority = table->givenPriority[changing];
+			readyQueueSetPriorityAs(readyQueue, changing, randomRange(&context->random, currentPriority / 2, currentPriority * 2 + 1), criteria);
+			if(context->verbosity >= VerbosityDebug) fprintf(out, "Process #%d's priority changed from %d to %d\n", table->PID[changing],
+				currentPriority, table->givenPriority[changing]);
+		}
+		
+		// Pick optimal processes, unless CFS process goes on with rest of its slice
+		int current = fairCurrent;
+		fairCurrent = -1;
+		if(current == -1){
+			instrumentTimerBegin(pick);
+			current = usesRunQueues ? featureIndex(popFront(runQueues[currentLevel])) : 
+				(usesFairQueue ? fairQueuePop(fairQueue) : readyQueuePopAs(readyQueue, criteria));
+			instrumentTimerEnd(pick, TimerPick);
+			instrumentCount(CounterPicks, 1);
+			if(usesFairQueue) fairSliceLeft = fairQueueSlice(fairQueue, current);
+			
+			if(context->verbosity >= VerbosityDebug){
+				fprintf(out, "Timestamp %03d: Picked #%d from among\n", timeline->timestamp, table->PID[current]);
+			}
+		}
+		
+		// Do job until current CPU burst ends at most
+		int left = table->CPUburstleft[current] - table->burstBoundary[current];
+		if(criteria == criteria_RR) // If round-robin, then use quantum time
+			runJob(timeline, current, min2(left, context->RRQuantumTime));
+		else if(criteria == criteria_MLFQ){ // Quantum time of current level, or until next process comes if not top level
+			int quantum = (currentLevel == levelNum - 1 ? inf : context->RRQuantumTime << currentLevel);
+			int duration = min2(left, quantum);
+			if(currentLevel > 0) duration = max2(1, min2(duration, next_come - timeline->timestamp));
+			runJob(timeline, current, duration);
+			level[current] = (duration == quantum ? currentLevel + 1 : currentLevel);
+		}
+		else if(criteria == criteria_CFS){ // Time slice by weight; If preemptive, stop when others come to check wakeup preemption
+			int duration = min2(left, fairSliceLeft);
+			if(preemptive) duration = min2(duration, next_come - timeline->timestamp);
+			runJob(timeline, current, duration);
+			fairQueueCharge(fairQueue, current, duration);
+			fairSliceLeft -= duration;
+		}
+		else if(preemptive){ // Do until next process comes
+			int duration = max2(1, min2(left, next_come - timeline->timestamp));
+			if(ProcessComparisonTicking[criteria]){ // Do until next process comes after switching, or someone overtakes
+				int limit = max2(1, min2(left, next_come - timeline->timestamp - pendingSwitchCost(timeline, current)));
+				duration = globalEventDrivenTicking ? agingCrossoverDuration(table, current, readyQueueTop(readyQueue), limit) : 1;
+			}
+			runJob(timeline, current, duration);
+		}
+		else // Do all and go next
+			runJob(timeline, current, left);
+			
+		// If current process bursted then record it, if current CPU burst ended then it does I/O,
+		// otherwise it goes back to ready queue
+		if(table->CPUburstleft[current] == 0){
+			if(finishedOrder != NULL) finishedOrder[finished] = current;
+			finished++;
+			arrivalRelease(source, current);
+		}
+		else if(table->CPUburstleft[current] == table->burstBoundary[current]){
+			int device = requestIO(devices, context->IODeviceNum, events, table, current, timeline->timestamp);
+			if(context->verbosity >= VerbosityDebug) fprintf(out, "Process #%d requested I/O burst to device %d\n", table->PID[current], device);
+		}
+		else if(usesFairQueue && fairSliceLeft > 0) fairCurrent = current; // Goes on unless new or woken one preempts it
+		else{
+			instrumentCount(CounterRequeues, 1);
+			if(usesRunQueues) requeued = current, requeuedLevel = (level == NULL ? 0 : level[current]);
+			else if(usesFairQueue) fairQueueEnqueue(fairQueue, current, FairEnqueuePreempted);
+			else readyQueuePushAs(readyQueue, current, criteria);
+		}
+	}
+	
+	closeTimeline(timeline);
+	instrumentAttach(NULL);
+	free(level);
+	deleteEventQueue(events);
+	deleteIODevices(devices, context->IODeviceNum);
+	if(readyQueue != NULL) deleteReadyQueue(readyQueue);
+	if(fairQueue != NULL) deleteFairQueue(fairQueue);
+	for(int l=0; l<levelNum; l++) if(runQueues[l] != NULL) deleteDeque(runQueues[l], false);
+}
+
+// Scheduling loop specialized at compile time. defineScheduleLoop(criteria_X, true) defines scheduleLoop_criteria_X_true,
+// where scheduleLoop and ready queue operations are inlined with constant criteria and preemptiveness,
+// so comparisons are inlined and branches for other policies are removed.
+typedef void (*ScheduleLoop)(ArrivalSource *source, Timeline *timeline, int *finishedOrder);
+#define defineScheduleLoop(criteria, preemptive) \
+	void scheduleLoop_##criteria##_##preemptive(ArrivalSource *source, Timeline *timeline, int *finishedOrder){ \
+		scheduleLoop(source, timeline, preemptive, criteria, finishedOrder); \
+	}
+#define defineScheduleLoops(criteria) defineScheduleLoop(criteria, false) defineScheduleLoop(criteria, true)
+#define scheduleLoopsOf(criteria) {scheduleLoop_##criteria##_false, scheduleLoop_##criteria##_true}
+defineScheduleLoops(criteria_FCFS)
+defineScheduleLoops(criteria_SJF)
+defineScheduleLoops(criteria_P)
+defineScheduleLoops(criteria_AGING)
+defineScheduleLoops(criteria_RR)
+defineScheduleLoops(criteria_PDy)
+defineScheduleLoops(criteria_MLFQ)
+defineScheduleLoops(criteria_CFS)
+
+// Scheduling loop of each [criteria][preemptive], which ScheduleFromSource runs
+ScheduleLoop scheduleLoops[criteria_COUNT][2] = {
+	scheduleLoopsOf(criteria_FCFS), scheduleLoopsOf(criteria_SJF), scheduleLoopsOf(criteria_P),
+	scheduleLoopsOf(criteria_AGING), scheduleLoopsOf(criteria_RR), scheduleLoopsOf(criteria_PDy),
+	scheduleLoopsOf(criteria_MLFQ), scheduleLoopsOf(criteria_CFS)
+};
+
+// Replace scheduling loop of given criteria and preemptiveness, e.g. with one defined by defineScheduleLoop
+// for modified scheduleLoop. Should be called before scheduling starts, since runs may be done in parallel.
+// Return false if criteria is out of range or loop is not given.
+bool registerScheduleLoop(ProcessComparisonCriteria criteria, bool preemptive, ScheduleLoop loop){
+	if((int)criteria < 0 || criteria >= criteria_COUNT || loop == NULL){
+		printf("[Warning] Invalid criteria(%d) or no loop given in registerScheduleLoop\n", (int)criteria);
+		return false;
+	}
+	scheduleLoops[criteria][preemptive ? 1 : 0] = loop;
+	return true;
+}
+
+// Run specialized scheduling loop of given policy
+void ScheduleFromSource(ArrivalSource *source, Timeline *timeline, bool preemptive, ProcessComparisonCriteria criteria, int *finishedOrder){
+	scheduleLoops[criteria][preemptive ? 1 : 0](source, timeline, finishedOrder);
+}
+
+// Scheduling processes of shared workload table, whose index i is i-th arrived process. Workload is not modified, and
+// returned timeline keeps its own overlay table and finished order until it is deleted.
+Timeline* ScheduleShared(const ProcessTable *workload, bool preemptive, 
+		ProcessComparisonCriteria criteria, int contextswitchingcost, ScheduleContext *context,
+		const char *timelineTitle){
+
+	// Prefix decoration
+	FILE *out = context->output;
+	if(context->verbosity >= VerbosityNormal){
+		fprintf(out, "\n"); fprintRepeat(out, "-", 80, false);
+		fprintf(out, "\nScheduling for timeline %s.\n\n", timelineTitle);
+	}
+	
+	// Scheduling
+	ProcessTable *table = newProcessTableOverlay(workload, criteria);
+	Timeline *timeline = newTimeline(workload->processNum, contextswitchingcost, context);
+	timeline->finishedOrder = (int*)countedMalloc(sizeof(int) * max2(workload->processNum, 1));
+	timeline->ownsTable = true;
+	ArrivalSource source = arraySource(table);
+	ScheduleFromSource(&source, timeline, preemptive, criteria, timeline->finishedOrder);
+	return timeline;
+}
+
+// General scheduling method. Processes are sorted by arrival, scheduled as workload, and written back in finished order.
+Timeline* ScheduleGeneral(Process *processes, int processNum, bool preemptive, 
+		ProcessComparisonCriteria criteria, int contextswitchingcost, ScheduleContext *context,
+		const char *timelineTitle){
+	mergeSort(processes, 0, processNum, criteria_FCFS);
+	ProcessTable *workload = newProcessTable(processes, processNum);
+	Timeline *timeline = ScheduleShared(workload, preemptive, criteria, contextswitchingcost, context, timelineTitle);
+	timeline->ownedWorkload = workload;
+	for(int i=0; i<processNum; i++) processes[i] = processFromTable(timeline->table, timeline->finishedOrder[i]);
+	return timeline;
+}
+
+// Scheduling processes read from trace. Only the latest segment of timeline is kept, and
+// finished processes are reflected into statistics of timeline only; memory doesn't depend on trace length.
+Timeline* ScheduleTrace(TraceReader *trace, bool preemptive, 
+		ProcessComparisonCriteria criteria, int contextswitchingcost, ScheduleContext *context,
+		const char *timelineTitle){
+	if(context->verbosity >= VerbosityNormal){
+		fprintf(context->output, "\n"); fprintRepeat(context->output, "-", 80, false);
+		fprintf(context->output, "\nScheduling trace %s for timeline %s.\n\n", trace->path, timelineTitle);
+	}
+	Timeline *timeline = newTimeline(0, contextswitchingcost, context);
+	timeline->keepSegments = false;
+	ArrivalSource source = traceSource(trace);
+	ScheduleFromSource(&source, timeline, preemptive, criteria, NULL);
+	timeline->processNum = timeline->stats.finishedNum;
+	free(source.freeSlots);
+	deleteProcessTable(source.table);
+	timeline->table = NULL;
+	return timeline;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Multi-core scheduling
+
+// Queue of ready processes which one core (or all cores, with global queue) picks from.
+// Round Robin uses FIFO deque, and other criterias use ready queue.
+struct CoreQueue__{
+	ReadyQueue *ready;
+	Deque *fifo;
+}; typedef struct CoreQueue__ CoreQueue;
+
+int coreQueueSize(CoreQueue *cq){return cq->ready != NULL ? cq->ready->size : cq->fifo->currentSize;}
+void coreQueuePush(CoreQueue *cq, int index){
+	if(cq->ready != NULL) readyQueuePush(cq->ready, index);
+	else pushBack(cq->fifo, indexFeature(index));
+}
+int coreQueuePop(CoreQueue *cq){return cq->ready != NULL ? readyQueuePop(cq->ready) : featureIndex(popFront(cq->fifo));}
+int coreQueueTop(CoreQueue *cq){return cq->ready != NULL ? readyQueueTop(cq->ready) : featureIndex(peekFront(cq->fifo));}
+
+// Take process for other core to steal: the one which would run last here, so victim keeps its next picks.
+int coreQueueSteal(CoreQueue *cq){
+	if(cq->fifo != NULL) return featureIndex(popBack(cq->fifo));
+	int stolen = readyQueueBottom(cq->ready);
+	readyQueueRemove(cq->ready, stolen);
+	return stolen;
+}
+
+// Timelines of all cores. Each core has its own lane, and all lanes share process table, which SMP timeline owns.
+struct SMPTimeline__{
+	int coreNum, processNum;
+	int migrations, steals;
+	ProcessTable *table, *ownedWorkload; // Same as Timeline
+	int *finishedOrder;
+	ScheduleContext *context;
+	Timeline **lanes;
+#ifdef useInstrumentation
+	Instrumentation instrumentation; // Of all cores
+#endif
+}; typedef struct SMPTimeline__ SMPTimeline;
+
+// Create new one
+SMPTimeline* newSMPTimeline(int processNum, int contextswitchingcost, ScheduleContext *context){
+	SMPTimeline *newCreatedOne = (SMPTimeline*)countedMalloc(sizeof(SMPTimeline));
+	newCreatedOne->coreNum = context->coreNum, newCreatedOne->processNum = processNum;
+	newCreatedOne->migrations = 0, newCreatedOne->steals = 0;
+	newCreatedOne->table = newCreatedOne->ownedWorkload = NULL;
+	newCreatedOne->finishedOrder = NULL;
+	newCreatedOne->context = context;
+	newCreatedOne->lanes = (Timeline**)countedMalloc(sizeof(Timeline*) * context->coreNum);
+	for(int c=0; c<context->coreNum; c++) newCreatedOne->lanes[c] = newTimeline(processNum, contextswitchingcost, context);
+#ifdef useInstrumentation
+	memset(&newCreatedOne->instrumentation, 0, sizeof(Instrumentation));
+#endif
+	return newCreatedOne;
+}
+
+// Delete timeline itself with all lanes
+void deleteSMPTimeline(SMPTimeline *smp){
+	for(int c=0; c<smp->coreNum; c++) deleteTimeline(smp->lanes[c]);
+	if(smp->table != NULL) deleteProcessTable(smp->table);
+	if(smp->ownedWorkload != NULL) deleteProcessTable(smp->ownedWorkload);
+	free(smp->finishedOrder);
+	free(smp->lanes);
+	free(smp);
+}
+
+// Multi-core version of ScheduleGeneral. Cores pick processes by context->balancing:
+//   LoadBalancingGlobal: All cores share single queue.
+//   LoadBalancingStealing: Each core has its own queue. Arrived process goes to least loaded core, and preempted or
+//     I/O finished process goes back to the core it ran last. Core whose queue is empty steals from longest queue
+//     the process which would run last there(see coreQueueSteal).
+//   LoadBalancingAffinity: Same as work stealing without stealing, so process never leaves the core it came to.
+// Process which runs on different core from last time costs migration cost on top of context switching cost.
+// Dynamically changing priorities, multilevel feedback queue and completely fair scheduling are single core only.
+// Workload is shared and not modified, same as ScheduleShared.
+SMPTimeline* ScheduleSharedSMP(const ProcessTable *workload, bool preemptive, 
+		ProcessComparisonCriteria criteria, int contextswitchingcost, ScheduleContext *context,
+		const char *timelineTitle){
+	
+	// Prefix decoration
+	FILE *out = context->output;
+	if(context->verbosity >= VerbosityNormal){
+		fprintf(out, "\n"); fprintRepeat(out, "-", 80, false);
+		fprintf(out, "\nScheduling for timeline %s on %d cores (%s).\n\n", timelineTitle, context->coreNum, 
+			LoadBalancingNames[context->balancing]);
+	}
+	if(criteria == criteria_PDy || criteria == criteria_MLFQ || criteria == criteria_CFS){
+		printf("[Error] Criteria %s is not supported in ScheduleSMP\n", ProcessComparisonNames[criteria]);
+		exit(-1);
+	}
+	
+	// Scheduling
+	// Core c is busy until its lane's timestamp if running[c] != -1. Global clock 'now' jumps to the earliest of
+	// arrival, I/O completion and end of running slices; at each point finished slices are resolved first,
+	// then idle cores pick from their queues, and then still idle cores steal.
+	int processNum = workload->processNum;
+	ProcessTable *table = newProcessTableOverlay(workload, criteria);
+	if(criteria == criteria_AGING) setProcessTableAging(table, &context->aging);
+	SMPTimeline *smp = newSMPTimeline(processNum, contextswitchingcost, context);
+	smp->table = table;
+	instrumentAttach(&smp->instrumentation);
+	int coreNum = context->coreNum, queueNum = (context->balancing == LoadBalancingGlobal ? 1 : coreNum);
+	for(int c=0; c<coreNum; c++) smp->lanes[c]->table = table;
+	CoreQueue *queues = (CoreQueue*)countedMalloc(sizeof(CoreQueue) * queueNum);
+	for(int q=0; q<queueNum; q++){
+		queues[q].ready = (criteria == criteria_RR ? NULL : newReadyQueue(processNum, table, criteria));
+		queues[q].fifo = (criteria == criteria_RR ? newDeque(0, "core run queue") : NULL);
+	}
+	int *running = (int*)countedMalloc(sizeof(int) * coreNum);
+	for(int c=0; c<coreNum; c++) running[c] = -1;
+	int *lastCore = (int*)countedMalloc(sizeof(int) * processNum); // Core which process ran on last, or home core for affinity
+	for(int i=0; i<processNum; i++) lastCore[i] = -1;
+	int *finishedOrder = smp->finishedOrder = (int*)countedMalloc(sizeof(int) * max2(processNum, 1));
+	EventQueue *events = newEventQueue(context->IODeviceNum);
+	IODevice *devices = newIODevices(context->IODeviceNum);
+	
+	// Queue which given process should go into
+	#define leastLoadedQueue(result) do{ \
+		result = 0; \
+		for(int q=1; q<queueNum; q++) \
+			if(coreQueueSize(queues + q) + (running[q] != -1) < coreQueueSize(queues + result) + (running[result] != -1)) result = q; \
+		} while(0)
+	#define queueOf(index) (queueNum == 1 || lastCore[index] == -1 ? 0 : lastCore[index])
+	
+	int now = 0, finished = 0, end = 0;
+	while(finished < processNum){
+		
+		// Arrivals, I/O completions and finished slices at now
+		while(end < processNum && table->arrivalTime[end] <= now){
+			int q; leastLoadedQueue(q);
+			if(context->balancing == LoadBalancingAffinity) lastCore[end] = q;
+			coreQueuePush(queues + q, end++);
+		}
+		while(eventQueueNextTime(events) <= now){
+			int returned = completeIO(devices, events, table);
+			coreQueuePush(queues + queueOf(returned), returned);
+		}
+		for(int c=0; c<coreNum; c++) if(running[c] != -1 && smp->lanes[c]->timestamp <= now){
+			int current = running[c];
+			running[c] = -1;
+			if(table->CPUburstleft[current] == 0) finishedOrder[finished++] = current;
+			else if(table->CPUburstleft[current] == table->burstBoundary[current])
+				requestIO(devices, context->IODeviceNum, events, table, current, smp->lanes[c]->timestamp);
+			else{
+				instrumentCount(CounterRequeues, 1);
+				coreQueuePush(queues + queueOf(current), current);
+			}
+		}
+		if(finished == processNum) break;
+		int next_come = min2(end < processNum ? table->arrivalTime[end] : inf, eventQueueNextTime(events));
+		
+		// Idle cores pick, and if there is nothing to pick then steal from longest queue
+		for(int pass=0; pass<2; pass++) for(int c=0; c<coreNum; c++){
+			if(running[c] != -1) continue;
+			CoreQueue *queue = queues + (queueNum == 1 ? 0 : c);
+			if(coreQueueSize(queue) == 0){
+				if(pass == 0 || context->balancing != LoadBalancingStealing) continue;
+				int victim = 0;
+				for(int q=1; q<queueNum; q++) if(coreQueueSize(queues + q) > coreQueueSize(queues + victim)) victim = q;
+				if(coreQueueSize(queues + victim) == 0) continue;
+				coreQueuePush(queue, coreQueueSteal(queues + victim));
+				smp->steals++;
+			}
+			instrumentTimerBegin(pick);
+			int current = coreQueuePop(queue);
+			instrumentTimerEnd(pick, TimerPick);
+			instrumentCount(CounterPicks, 1);
+			Timeline *lane = smp->lanes[c];
+			if(lane->timestamp < now) runJob(lane, -1, now - lane->timestamp);
+			if(lastCore[current] != -1 && lastCore[current] != c){ // Migration
+				bool switching = (lane->openPID != -1);
+				int cost = context->migrationCost + (switching ? contextswitchingcost : 0);
+				if(cost > 0){ // Otherwise no segment is inserted, and doJobFor counts the switch itself
+					if(switching) lane->stats.contextSwitches++;
+					runJob(lane, -1, cost);
+				}
+				smp->migrations++;
+			}
+			lastCore[current] = c;
+			if(context->verbosity >= VerbosityDebug) fprintf(out, "Timestamp %03d: Core %d picked #%d\n", now, c, table->PID[current]);
+			
+			// Do job until current CPU burst ends at most
+			int left = table->CPUburstleft[current] - table->burstBoundary[current], duration = left;
+			if(criteria == criteria_RR) duration = min2(left, context->RRQuantumTime);
+			else if(preemptive){
+				duration = max2(1, min2(left, next_come - now));
+				if(ProcessComparisonTicking[criteria]){ // Limit starts after migration and switching, same as ScheduleGeneral
+					int limit = max2(1, min2(left, next_come - lane->timestamp - pendingSwitchCost(lane, current)));
+					duration = globalEventDrivenTicking ? agingCrossoverDuration(table, current, coreQueueTop(queue), limit) : 1;
+				}
+			}
+			runJob(lane, current, duration);
+			running[c] = current;
+		}
+		
+		// Go to next point
+		int next = next_come;
+		for(int c=0; c<coreNum; c++) if(running[c] != -1) next = min2(next, smp->lanes[c]->timestamp);
+		if(next == inf){
+			printf("[Error] Something wrong happened in ScheduleSMP (%s), all processes done but loop is not ended.\n",
+				ProcessComparisonNames[criteria]);
+			exit(-1);
+		}
+		now = max2(now, next);
+	}
+	#undef leastLoadedQueue
+	#undef queueOf
+	
+	free(lastCore); free(running);
+	for(int q=0; q<queueNum; q++){
+		if(queues[q].ready != NULL) deleteReadyQueue(queues[q].ready);
+		if(queues[q].fifo != NULL) deleteDeque(queues[q].fifo, false);
+	} free(queues);
+	deleteEventQueue(events);
+	deleteIODevices(devices, context->IODeviceNum);
+	for(int c=0; c<coreNum; c++) closeTimeline(smp->lanes[c]);
+	instrumentAttach(NULL);
+	return smp;
+}
+
+// Multi-core version of ScheduleGeneral. Processes are sorted by arrival, scheduled as workload, and written back in finished order.
+SMPTimeline* ScheduleSMP(Process *processes, int processNum, bool preemptive, 
+		ProcessComparisonCriteria criteria, int contextswitchingcost, ScheduleContext *context,
+		const char *timelineTitle){
+	mergeSort(processes, 0, processNum, criteria_FCFS);
+	ProcessTable *workload = newProcessTable(processes, processNum);
+	SMPTimeline *smp = ScheduleSharedSMP(workload, preemptive, criteria, contextswitchingcost, context, timelineTitle);
+	smp->ownedWorkload = workload;
+	for(int i=0; i<processNum; i++) processes[i] = processFromTable(smp->table, smp->finishedOrder[i]);
+	return smp;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Gantt chart displaying
+
+// Processes info in finished order
+void writeProcessesStatistics(OutputWriter *writer, ProcessTable *table, int *finishedOrder, int processNum){
+	writerPutString(writer, "Processes: \n");
+	for(int i=0; i<processNum; i++){
+		Process finished = processFromTable(table, finishedOrder[i]);
+		writerPutString(writer, "  "); 
+		writeSingleProcess(writer, &finished, ProcessRepresentStatistics); 
+		writerPutChar(writer, '\n');
+	} writerPutChar(writer, '\n');
+}
+
+// Vertical Gantt chart of single timeline
+void writeGanttLane(OutputWriter *writer, Timeline *timeline){
+	for(int i=0; i<timeline->timelinesize; i++){
+		writerPutInt(writer, timeline->interval[i][0], 4, ' ');
+		writerPutString(writer, " +-----------+\n     | PID = ");
+		if(timeline->usedProcessesPID[i] == -1) writerPutString(writer, "---");
+		else writerPutInt(writer, timeline->usedProcessesPID[i], 3, '0');
+		writerPutString(writer, " |\n");
+	}
+	writerPutInt(writer, timeline->interval[timeline->timelinesize-1][1], 4, ' ');
+	writerPutString(writer, " +-----------+\n\n");
+}
+
+// Average turnaround time and waiting time. Waiting time doesn't include I/O bursts.
+// Distributions of them and response time follow if detailed is true.
+void writeAverageTimes(OutputWriter *writer, ScheduleStatistics *stats, bool detailed){
+	int processNum = max2(stats->finishedNum, 1);
+	writerPrintf(writer, "Average turnaround %.2f, average waiting %.2f\n", 
+		(double)stats->turnaround.sum / processNum, (double)stats->waiting.sum / processNum);
+	if(!detailed) return;
+	const char *names[3] = {"Turnaround", "Waiting", "Response"};
+	RunningMetric *metrics[3] = {&stats->turnaround, &stats->waiting, &stats->response};
+	for(int i=0; i<3; i++) writerPrintf(writer, "%-10s mean %.2f, stddev %.2f, p50 %d, p95 %d, p99 %d, max %d\n", names[i],
+		metrics[i]->mean, runningMetricStddev(metrics[i]), runningMetricPercentile(metrics[i], 0.50),
+		runningMetricPercentile(metrics[i], 0.95), runningMetricPercentile(metrics[i], 0.99), metrics[i]->count > 0 ? metrics[i]->maxValue : 0);
+	writerPrintf(writer, "Context switches %lld\n", stats->contextSwitches);
+}
+
+// CPU utilization over all cores and throughput
+void writeUtilization(OutputWriter *writer, long long busy, int coreNum, int makespan, int processNum){
+	writerPrintf(writer, "CPU utilization %.2f%%, throughput %.4f processes per time unit\n",
+		makespan > 0 ? 100.0 * busy / ((double)makespan * coreNum) : 0.0, makespan > 0 ? (double)processNum / makespan : 0.0);
+}
+
+#ifdef useInstrumentation
+// Counters and cycle timers of run. Dispatches and context switches are taken from statistics.
+void writeInstrumentation(OutputWriter *writer, Instrumentation *instrumentation, ScheduleStatistics *stats){
+	long long *counters = instrumentation->counters;
+	unsigned long long *cycles = instrumentation->cycles;
+	writerPrintf(writer, "Instrumentation: comparisons %lld, picks %lld (scanned %lld), dispatches %lld, requeues %lld\n",
+		counters[CounterComparisons], counters[CounterPicks], counters[CounterPickScanned], stats->dispatches, counters[CounterRequeues]);
+	writerPrintf(writer, "  segments appended %lld, coalesced %lld, context switches %lld (%lld segments inserted)\n",
+		counters[CounterSegmentsAppended], counters[CounterSegmentsCoalesced], stats->contextSwitches, counters[CounterSwitchSegments]);
+	writerPrintf(writer, "  cycles: pick %llu (%.1f per pick), doJobFor %llu (%.1f per dispatch), Gantt chart %llu\n",
+		cycles[TimerPick], (double)cycles[TimerPick] / (counters[CounterPicks] > 0 ? counters[CounterPicks] : 1),
+		cycles[TimerDispatch], (double)cycles[TimerDispatch] / (stats->dispatches > 0 ? stats->dispatches : 1), cycles[TimerGanttChart]);
+}
+#endif
+
+// Display Gantt chart into timeline's context output. Summary verbosity shows only averages and utilization.
+void GanttChart(Timeline *timeline, const char *timelineTitle){
+	Verbosity verbosity = timeline->context->verbosity;
+	if(verbosity == VerbosityQuiet) return;
+	instrumentTimerBegin(chart);
+	
+	// Validation
+	if(timeline->timelinesize == 0){
+		fprintf(timeline->context->output, "[Warning] Tried to print empty timeline\n");
+		return;
+	}
+	OutputWriter *writer = newOutputWriter(timeline->context->output);
+	
+	// Prefix decoration
+	writerPutChar(writer, '\n'); writerPutRepeat(writer, '-', 80);
+	writerPrintf(writer, "\nGantt chart for timeline %s.\n\n", timelineTitle);
+	
+	// Main 1: Processes info
+	if(verbosity >= VerbosityNormal) writeProcessesStatistics(writer, timeline->table, timeline->finishedOrder, timeline->processNum);
+	
+	// Main 2: Vertical Gantt chart
+	if(verbosity >= VerbosityNormal){
+		writerPutString(writer, "Timeline: \n");
+		writeGanttLane(writer, timeline);
+	}
+	
+	// Main 3: Average turnaround time and waiting time
+	writeAverageTimes(writer, &timeline->stats, true);
+	
+	// Main 4: CPU utilization and throughput
+	writeUtilization(writer, timeline->stats.busyTime, 1, timeline->timestamp, timeline->stats.finishedNum);
+#ifdef useInstrumentation
+	instrumentTimerEndInto(chart, TimerGanttChart, &timeline->instrumentation);
+	writeInstrumentation(writer, &timeline->instrumentation, &timeline->stats);
+#endif
+	deleteOutputWriter(writer);
+}
+
+// Display Gantt chart of every core into timeline's context output
+void SMPGanttChart(SMPTimeline *smp, const char *timelineTitle){
+	Verbosity verbosity = smp->context->verbosity;
+	if(verbosity == VerbosityQuiet) return;
+	instrumentTimerBegin(chart);
+	OutputWriter *writer = newOutputWriter(smp->context->output);
+	
+	// Prefix decoration
+	writerPutChar(writer, '\n'); writerPutRepeat(writer, '-', 80);
+	writerPrintf(writer, "\nGantt chart for timeline %s on %d cores.\n\n", timelineTitle, smp->coreNum);
+	
+	// Main 1: Processes info
+	if(verbosity >= VerbosityNormal) writeProcessesStatistics(writer, smp->table, smp->finishedOrder, smp->processNum);
+	
+	// Main 2: Vertical Gantt chart of each core. Core which did nothing has empty lane.
+	int makespan = 0;
+	ScheduleStatistics *stats = (ScheduleStatistics*)countedMalloc(sizeof(ScheduleStatistics));
+	initScheduleStatistics(stats);
+	for(int c=0; c<smp->coreNum; c++){
+		Timeline *lane = smp->lanes[c];
+		if(lane->timelinesize == 0){
+			if(verbosity >= VerbosityNormal) writerPrintf(writer, "Timeline of core %d: \n  (idle)\n\n", c);
+			continue;
+		}
+		if(verbosity >= VerbosityNormal){
+			writerPrintf(writer, "Timeline of core %d: \n", c);
+			writeGanttLane(writer, lane);
+		}
+		mergeScheduleStatistics(stats, &lane->stats);
+		makespan = max2(makespan, lane->timestamp);
+	}
+	
+	// Main 3: Average turnaround time and waiting time
+	writeAverageTimes(writer, stats, true);
+	
+	// Main 4: CPU utilization and throughput, and load balancing
+	writeUtilization(writer, stats->busyTime, smp->coreNum, makespan, stats->finishedNum);
+	writerPrintf(writer, "Migrations %d, steals %d (migration cost %d)\n", smp->migrations, smp->steals, smp->context->migrationCost);
+#ifdef useInstrumentation
+	instrumentTimerEndInto(chart, TimerGanttChart, &smp->instrumentation);
+	writeInstrumentation(writer, &smp->instrumentation, stats);
+#endif
+	free(stats);
+	deleteOutputWriter(writer);
+}
+
+// Display statistics of timeline scheduled from trace
+void TraceSummary(Timeline *timeline, const char *timelineTitle){
+	if(timeline->context->verbosity == VerbosityQuiet) return;
+	OutputWriter *writer = newOutputWriter(timeline->context->output);
+	writerPrintf(writer, "\nTrace summary for timeline %s: %d processes, finished at %d\n", 
+		timelineTitle, timeline->stats.finishedNum, timeline->timestamp);
+	writeAverageTimes(writer, &timeline->stats, true);
+	writeUtilization(writer, timeline->stats.busyTime, 1, timeline->timestamp, timeline->stats.finishedNum);
+#ifdef useInstrumentation
+	writeInstrumentation(writer, &timeline->instrumentation, &timeline->stats);
+#endif
+	deleteOutputWriter(writer);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Timeline export
+
+// Timeline of laneNum cores (1 for single core) is exported with finished processes, under title of its policy.
+// Binary format, all integers are unsigned LEB128 varints:
+//   "KUTL", version(2), title length, title bytes, laneNum, then for each lane: segmentNum, and for each segment
+//   (PID + 1, start - end of previous segment, end - start). PID + 1 = 0 means idle or context switching.
+//   Records of several timelines just follow each other.
+// CSV format: "policy,core,pid,start,end" rows, after single header row(see exportTimelinesBegin).
+// JSON format: {"title", "cores", "processes": [...], "segments": [[core, pid, start, end], ...]}, as element of
+// single array of all timelines.
+#define timelineBinaryVersion 2
+void exportTimelineBinary(OutputWriter *writer, Timeline **lanes, int laneNum, const char *title){
+	writerPutBytes(writer, "KUTL", 4);
+	writerPutVarint(writer, timelineBinaryVersion);
+	writerPutVarint(writer, strlen(title));
+	writerPutString(writer, title);
+	writerPutVarint(writer, laneNum);
+	for(int c=0; c<laneNum; c++){
+		Timeline *lane = lanes[c];
+		writerPutVarint(writer, lane->timelinesize);
+		int previousEnd = 0;
+		for(int i=0; i<lane->timelinesize; i++){
+			writerPutVarint(writer, (unsigned int)(lane->usedProcessesPID[i] + 1));
+			writerPutVarint(writer, (unsigned int)(lane->interval[i][0] - previousEnd));
+			writerPutVarint(writer, (unsigned int)(lane->interval[i][1] - lane->interval[i][0]));
+			previousEnd = lane->interval[i][1];
+		}
+	}
+}
+void exportTimelineCSV(OutputWriter *writer, Timeline **lanes, int laneNum, const char *title){
+	for(int c=0; c<laneNum; c++) for(int i=0; i<lanes[c]->timelinesize; i++){
+		writerPutCSVField(writer, title); writerPutChar(writer, ',');
+		writerPutInt(writer, c, 0, ' '); writerPutChar(writer, ',');
+		writerPutInt(writer, lanes[c]->usedProcessesPID[i], 0, ' '); writerPutChar(writer, ',');
+		writerPutInt(writer, lanes[c]->interval[i][0], 0, ' '); writerPutChar(writer, ',');
+		writerPutInt(writer, lanes[c]->interval[i][1], 0, ' '); writerPutChar(writer, '\n');
+	}
+}
+void exportTimelineJSON(OutputWriter *writer, Timeline **lanes, int laneNum, ProcessTable *table, int *finishedOrder, int processNum, 
+		const char *title){
+	writerPutString(writer, "{\"title\": "); writerPutJSONString(writer, title);
+	writerPrintf(writer, ", \"cores\": %d, \"processes\": [", laneNum);
+	for(int i=0; i<processNum; i++){
+		Process finished = processFromTable(table, finishedOrder[i]), *p = &finished;
+		writerPrintf(writer, "%s\n  {\"pid\": %d, \"cpu\": %d, \"io\": %d, \"ioCount\": %d, \"arrival\": %d, \"priority\": %d, \"finished\": %d}",
+			i == 0 ? "" : ",", p->PID, p->CPUburst, p->IOburst, p->IOcount, p->arrivalTime, p->givenPriority, p->finishedTime);
+	}
+	writerPutString(writer, "],\n \"segments\": [");
+	bool first = true;
+	for(int c=0; c<laneNum; c++) for(int i=0; i<lanes[c]->timelinesize; i++){
+		writerPutString(writer, first ? "\n  [" : ",\n  [");
+		writerPutInt(writer, c, 0, ' '); writerPutString(writer, ", ");
+		writerPutInt(writer, lanes[c]->usedProcessesPID[i], 0, ' '); writerPutString(writer, ", ");
+		writerPutInt(writer, lanes[c]->interval[i][0], 0, ' '); writerPutString(writer, ", ");
+		writerPutInt(writer, lanes[c]->interval[i][1], 0, ' '); writerPutChar(writer, ']');
+		first = false;
+	}
+	writerPutString(writer, "]}\n");
+}
+
+// Export timeline of all lanes into given file in given format. Text format is Gantt chart.
+void exportTimeline(FILE *out, TimelineFormat format, Timeline **lanes, int laneNum, ProcessTable *table, int *finishedOrder, int processNum, 
+		const char *title){
+	OutputWriter *writer = newOutputWriter(out);
+	switch(format){
+		case TimelineFormatBinary: exportTimelineBinary(writer, lanes, laneNum, title); break;
+		case TimelineFormatCSV: exportTimelineCSV(writer, lanes, laneNum, title); break;
+		case TimelineFormatJSON: exportTimelineJSON(writer, lanes, laneNum, table, finishedOrder, processNum, title); break;
+		case TimelineFormatText:
+			for(int c=0; c<laneNum; c++) if(lanes[c]->timelinesize > 0){
+				writerPrintf(writer, "Timeline of core %d: \n", c);
+				writeGanttLane(writer, lanes[c]);
+			} break;
+	}
+	deleteOutputWriter(writer);
+}
+
+// Framing around exports of several timelines in a row, so that whole output is single document:
+// CSV header row comes once, and JSON objects become elements of single array. Binary records need nothing.
+void exportTimelinesBegin(FILE *out, TimelineFormat format){
+	if(format == TimelineFormatCSV) fputs("policy,core,pid,start,end\n", out);
+	else if(format == TimelineFormatJSON) fputs("[", out);
+}
+void exportTimelinesBetween(FILE *out, TimelineFormat format){
+	if(format == TimelineFormatJSON) fputs(",", out);
+}
+void exportTimelinesEnd(FILE *out, TimelineFormat format){
+	if(format == TimelineFormatJSON) fputs("]\n", out);
+}
+
+// Read single binary exported timeline back. Return number of lanes read into lanes (at most maxLaneNum), or -1 if 
+// malformed. Lanes are newly created timelines without processes and context. Title is copied into given buffer
+// (cut to titleCapacity - 1 bytes) if it is not NULL, and length of record is stored into consumed if it is not NULL,
+// so records following each other can be read one by one.
+int importTimelineBinary(const unsigned char *data, size_t size, Timeline **lanes, int maxLaneNum, 
+		char *title, int titleCapacity, size_t *consumed){
+	size_t position = 0;
+	bool malformed = false;
+	#define readVarint(result) do{ \
+		unsigned long long value_ = 0; int shift_ = 0; \
+		while(true){ \
+			if(position >= size || shift_ > 63){ malformed = true; break; } \
+			value_ |= (unsigned long long)(data[position] & 0x7F) << shift_; shift_ += 7; \
+			if(!(data[position++] & 0x80)) break; \
+		} result = value_; \
+	} while(0)
+	if(size < 4 || memcmp(data, "KUTL", 4) != 0) return -1;
+	position = 4;
+	unsigned long long version, titleLength, laneNum;
+	readVarint(version); readVarint(titleLength);
+	if(malformed || version != timelineBinaryVersion || titleLength > size - position) return -1;
+	if(title != NULL && titleCapacity > 0){
+		int copied = (int)(titleLength < (unsigned long long)titleCapacity ? titleLength : (unsigned long long)titleCapacity - 1);
+		memcpy(title, data + position, copied);
+		title[copied] = '\0';
+	}
+	position += titleLength;
+	readVarint(laneNum);
+	if(malformed || laneNum > (unsigned long long)maxLaneNum) return -1;
+	for(int c=0; c<(int)laneNum; c++){
+		unsigned long long segmentNum, PID, gap, length;
+		readVarint(segmentNum);
+		lanes[c] = newTimeline(0, 0, NULL);
+		int previousEnd = 0;
+		for(unsigned long long i=0; i<segmentNum && !malformed; i++){
+			readVarint(PID); readVarint(gap); readVarint(length);
+			reserveTimelineSegment(lanes[c]);
+			lanes[c]->usedProcessesPID[lanes[c]->timelinesize] = (int)PID - 1;
+			lanes[c]->interval[lanes[c]->timelinesize][0] = previousEnd + (int)gap;
+			lanes[c]->interval[lanes[c]->timelinesize][1] = previousEnd = previousEnd + (int)gap + (int)length;
+			lanes[c]->timelinesize++;
+		}
+		lanes[c]->timestamp = previousEnd;
+		if(malformed){
+			for(int d=0; d<=c; d++) deleteTimeline(lanes[d]);
+			return -1;
+		}
+	}
+	#undef readVarint
+	if(consumed != NULL) *consumed = position;
+	return (int)laneNum;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Thread pool
+
+// Work stealing pool for fixed set of independent tasks [0, taskNum). Tasks are dealt to deques of workers in
+// round robin order; Each worker pops its own deque from back, and steals from front of others' when it is empty.
+// No task is added while running, so worker stops when it finds every deque empty.
+// Worker 0 is calling thread, and deque of worker whose thread can't be created is left to be stolen.
+typedef void (*PoolTask)(void *shared, int task);
+struct TaskPool__;
+struct PoolWorker__{
+	Deque *tasks; // Features are task numbers
+	pthread_mutex_t lock; // Guards tasks
+	struct TaskPool__ *pool;
+	int id;
+	int ran, stolen;
+}; typedef struct PoolWorker__ PoolWorker;
+struct TaskPool__{
+	PoolWorker *workers;
+	int workerNum;
+	PoolTask run;
+	void *shared;
+}; typedef struct TaskPool__ TaskPool;
+
+// Take next task of worker, own one first. Return -1 if there is nothing left anywhere.
+int poolTakeTask(PoolWorker *self){
+	TaskPool *pool = self->pool;
+	int task = -1;
+	pthread_mutex_lock(&self->lock);
+	if(self->tasks->currentSize > 0) task = featureIndex(popBack(self->tasks));
+	pthread_mutex_unlock(&self->lock);
+	for(int v=1; task == -1 && v<pool->workerNum; v++){
+		PoolWorker *victim = pool->workers + (self->id + v) % pool->workerNum;
+		pthread_mutex_lock(&victim->lock);
+		if(victim->tasks->currentSize > 0) task = featureIndex(popFront(victim->tasks)), self->stolen++;
+		pthread_mutex_unlock(&victim->lock);
+	} return task;
+}
+
+// Thread routine of worker
+void* poolWorkerLoop(void *arg){
+	PoolWorker *self = (PoolWorker*)arg;
+	for(int task = poolTakeTask(self); task != -1; task = poolTakeTask(self)){
+		self->pool->run(self->pool->shared, task);
+		self->ran++;
+	} return NULL;
+}
+
+// Run all tasks on workerNum workers and wait until they are done. Return number of stolen tasks.
+int runTaskPool(PoolTask run, void *shared, int taskNum, int workerNum){
+	TaskPool pool = {NULL, max2(1, workerNum), run, shared};
+	pool.workers = (PoolWorker*)countedMalloc(sizeof(PoolWorker) * pool.workerNum);
+	for(int w=0; w<pool.workerNum; w++){
+		PoolWorker *worker = pool.workers + w;
+		worker->tasks = newDeque(0, "pool tasks");
+		pthread_mutex_init(&worker->lock, NULL);
+		worker->pool = &pool, worker->id = w;
+		worker->ran = 0, worker->stolen = 0;
+	}
+	for(int t=0; t<taskNum; t++) pushBack(pool.workers[t % pool.workerNum].tasks, indexFeature(t));
+	pthread_t *threads = (pthread_t*)countedMalloc(sizeof(pthread_t) * pool.workerNum);
+	bool *threadCreated = (bool*)countedCalloc(pool.workerNum, sizeof(bool));
+	for(int w=1; w<pool.workerNum; w++) threadCreated[w] = (pthread_create(threads + w, NULL, poolWorkerLoop, pool.workers + w) == 0);
+	poolWorkerLoop(pool.workers);
+	for(int w=1; w<pool.workerNum; w++) if(threadCreated[w]) pthread_join(threads[w], NULL);
+	int stolen = 0;
+	for(int w=0; w<pool.workerNum; w++){ // Others may look into any deque until they stop
+		stolen += pool.workers[w].stolen;
+		pthread_mutex_destroy(&pool.workers[w].lock);
+		deleteDeque(pool.workers[w].tasks, false);
+	}
+	free(threads); free(threadCreated); free(pool.workers);
+	return stolen;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Functionality testing
+
+// Testing selection sort on processes
+void SelectionSortFunctionalityTest(){
+	
+	// Process randomizing
+	const int processNum = 10;
+	Process *processes = (Process*)countedMalloc(sizeof(Process) * processNum);
+	for(int i=0; i<processNum; i++) *(processes+i) = createRandomProcess(&globalRandomStream, 20, 0, 0, 10, 1, 5);
+	
+	// Sort in 3 different criterias
+	const char criteria_str[3][100] = {"FCFS", "SJF", "Priority"};
+	printf("Before sorted - "); reprMultiProcesses(processes, processNum, ProcessRepresentMinimal);
+	for(int criteria = 0; criteria < 3; criteria++){
+		selectionSort(processes, 0, processNum, criteria);
+		printf("\n\nAfter sorted by %s - ", criteria_str[criteria]);
+		reprMultiProcesses(processes, processNum, ProcessRepresentMinimal);
+	}
+	free(processes);
+}
+
+// Testing merge sort on processes by comparing with selection sort
+void MergeSortFunctionalityTest(){
+	
+	// Process randomizing
+	const int processNum = 1000;
+	Process *processes = (Process*)countedMalloc(sizeof(Process) * processNum);
+	for(int i=0; i<processNum; i++) *(processes+i) = createRandomProcess(&globalRandomStream, 20, 0, 0, 100, 1, 5);
+	
+	// Sort in 3 different criterias
+	const char criteria_str[3][100] = {"FCFS", "SJF", "Priority"};
+	for(int criteria = 0; criteria < 3; criteria++){
+		Process *selectionSorted = deepCopyProcesses(processes, processNum);
+		selectionSort(selectionSorted, 0, processNum, criteria);
+		mergeSort(processes, 0, processNum, criteria);
+		bool same = true;
+		for(int i=0; i<processNum; i++) if(processes[i].PID != selectionSorted[i].PID) same = false;
+		printf("Merge sort by %s: %s\n", criteria_str[criteria], testVerdict(same, "Mismatch with selection sort"));
+		free(selectionSorted);
+	}
+	free(processes);
+}
+
+// Single policy evaluated in schedulingTests
+struct PolicyRun__{
+	const char *title;
+	ProcessComparisonCriteria criteria;
+	bool preemptive;
+	bool multiCore; // Scheduled by ScheduleSMP with global multi-core configuration
+	
+	// Filled by schedulingTests. Workload is shared by all runs and read only.
+	const ProcessTable *workload;
+	int contextswitchingcost;
+	ScheduleContext context;
+	char *outputBuffer; size_t outputSize; // Used only if run in parallel
+}; typedef struct PolicyRun__ PolicyRun;
+
+// Schedule and display single policy. Can be used as thread routine.
+void* runPolicy(void *arg){
+	PolicyRun *run = (PolicyRun*)arg;
+	bool text = (run->context.format == TimelineFormatText);
+	if(run->multiCore){
+		SMPTimeline *scheduled = ScheduleSharedSMP(run->workload, run->preemptive, run->criteria, 
+			run->contextswitchingcost, &run->context, run->title);
+		if(text) SMPGanttChart(scheduled, run->title);
+		else exportTimeline(run->context.output, run->context.format, scheduled->lanes, scheduled->coreNum, 
+			scheduled->table, scheduled->finishedOrder, scheduled->processNum, run->title);
+		deleteSMPTimeline(scheduled);
+	}
+	else{
+		Timeline *scheduled = ScheduleShared(run->workload, run->preemptive, run->criteria, 
+			run->contextswitchingcost, &run->context, run->title);
+		if(text) GanttChart(scheduled, run->title);
+		else exportTimeline(run->context.output, run->context.format, &scheduled, 1, 
+			scheduled->table, scheduled->finishedOrder, scheduled->processNum, run->title);
+		deleteTimeline(scheduled);
+	}
+	if(text && run->context.verbosity >= VerbositySummary && (run->criteria == criteria_RR || run->criteria == criteria_MLFQ))
+		fprintf(run->context.output, "Round Robin Quantum time = %d\n", run->context.RRQuantumTime);
+	if(text && run->context.verbosity >= VerbositySummary && run->criteria == criteria_CFS)
+		fprintf(run->context.output, "CFS target latency = %d, minimum granularity = %d, wakeup granularity = %d\n", 
+			run->context.CFSTargetLatency, run->context.CFSMinGranularity, run->context.CFSWakeupGranularity);
+	return NULL;
+}
+
+// Testing workload generator by comparing sample means and tail with expected ones. Samples are rounded down, so
+// expected means are of rounded down distributions: sum of P(X >= k) over k >= 1, which is 1 / (exp(1 / mean) - 1) 
+// for exponential, plus P(X < 1) for CPU bursts clamped to 1. Tail is P(inter-arrival >= 20) = (5 / 20)^3.
+void WorkloadGeneratorFunctionalityTest(){
+	const int processNum = 1000000;
+	WorkloadConfig config;
+	config.CPUburst = newDistribution(DistributionExponential, 20, 0, 0, 1, inf);
+	config.IOburst = newDistribution(DistributionBimodal, 2, 50, 0.1, 0, inf);
+	config.IOcount = newDistribution(DistributionUniform, 0, 3, 0, 0, 3);
+	config.interArrival = newDistribution(DistributionPareto, 5, 3, 0, 0, inf);
+	config.minPriority = 1, config.maxPriority = 5;
+	Workload *workload = generateWorkload(&config, processNum, 12345, 4);
+	double CPUsum = 0, IOsum = 0; int tailNum = 0;
+	for(int i=0; i<processNum; i++){
+		CPUsum += workload->CPUburst[i], IOsum += workload->IOburst[i];
+		if(workload->arrivalTime[i] - (i > 0 ? workload->arrivalTime[i-1] : 0) >= 20) tailNum++;
+	}
+	double CPUmean = CPUsum / processNum, IOmean = IOsum / processNum;
+	double arrivalMean = (double)workload->arrivalTime[processNum-1] / processNum, tail = (double)tailNum / processNum;
+	double expectedCPU = 1.0 / (exp(1.0 / 20) - 1) + (1.0 - exp(-1.0 / 20));
+	double expectedIO = 0.9 / (exp(1.0 / 2) - 1) + 0.1 / (exp(1.0 / 50) - 1);
+	double expectedArrival = 5, expectedTail = 1.0 / 64;
+	for(int k=6; k<100000; k++) expectedArrival += pow(5.0 / k, 3);
+	printf("After rounding down: CPU burst mean %.3f (%.3f), I/O burst mean %.3f (%.3f), inter-arrival mean %.3f (%.3f), "
+		"inter-arrival tail %.5f (%.5f)\n", CPUmean, expectedCPU, IOmean, expectedIO, arrivalMean, expectedArrival, tail, expectedTail);
+	bool close = fabs(CPUmean - expectedCPU) < 0.1 && fabs(IOmean - expectedIO) < 0.1 && 
+		fabs(arrivalMean - expectedArrival) < 0.05 && fabs(tail - expectedTail) < 0.001;
+	printf("Sample means and tail within tolerance: %s\n", testVerdict(close, "Mismatch"));
+	Workload *again = generateWorkload(&config, processNum, 12345, 1);
+	bool same = true;
+	for(int i=0; i<processNum; i++) if(workload->CPUburst[i] != again->CPUburst[i] || workload->arrivalTime[i] != again->arrivalTime[i]) same = false;
+	printf("Same result with different thread count: %s\n", testVerdict(same, "Mismatch"));
+	deleteWorkload(workload); deleteWorkload(again);
+	
+	// Heavy tailed workload of schedulingTests
+	Process *processes = randomizeProcesses(WorkloadHeavyTailed, 12345, 0, processNum, 30, 4, 0, 4);
+	double burstSum = 0; bool sorted = true;
+	for(int i=0; i<processNum; i++){
+		burstSum += processes[i].CPUburst;
+		if(i > 0 && processes[i].arrivalTime < processes[i-1].arrivalTime) sorted = false;
+	}
+	printf("Heavy tailed workload: CPU burst mean %.2f (30 before rounding down), arrival mean %.3f (4), sorted %s\n", 
+		burstSum / processNum, (double)processes[processNum-1].arrivalTime / processNum, testVerdict(sorted, "Mismatch"));
+	free(processes);
+}
+
+// Testing vectorized argmin kernels by comparing with scalar one
+void ArgminKernelFunctionalityTest(){
+	pthread_once(&argminKernelSelected, selectArgminKernel);
+	RandomStream rs; seedRandomStream(&rs, 12345, 0);
+	unsigned long long keys[300];
+	bool same = true;
+	for(int trial=0; trial<10000; trial++){
+		int n = randomRange(&rs, 1, 300);
+		for(int i=0; i<n; i++) keys[i] = trial % 2 ? nextRandom(&rs) : randomRange(&rs, 0, 5); // Also test ties
+		if(argminKeys(keys, n) != argminKeysScalar(keys, n)) same = false;
+	}
+	printf("Argmin kernel: %s\n", testVerdict(same, "Mismatch with scalar kernel"));
+}
+
+// Testing indexed ready queue operations against brute force search, across both flat and heap modes
+void IndexedHeapFunctionalityTest(){
+	RandomStream rs; seedRandomStream(&rs, 12345, 0);
+	const int processNum = 400;
+	Process *processes = (Process*)countedMalloc(sizeof(Process) * processNum);
+	for(int i=0; i<processNum; i++) processes[i] = createRandomProcess(&rs, 50, 0, 0, 1000, 1, 20);
+	ProcessComparisonCriteria criterias[3] = {criteria_PDy, criteria_SJF, criteria_AGING};
+	bool same = true;
+	for(int c=0; c<3; c++){
+		ProcessTable *table = newProcessTable(processes, processNum);
+		ReadyQueue *rq = newReadyQueue(16, table, criterias[c]);
+		bool *inQueue = (bool*)countedCalloc(processNum, sizeof(bool));
+		for(int step=0; step<100000; step++){
+			int index = randomRange(&rs, 0, processNum - 1), operation = randomRange(&rs, 0, 3);
+			if(operation == 0 && !inQueue[index]) readyQueuePush(rq, index), inQueue[index] = true;
+			else if(operation == 1 && rq->size > 0) inQueue[readyQueuePop(rq)] = false;
+			else if(operation == 2){
+				if(readyQueueRemove(rq, index) != inQueue[index]) same = false;
+				inQueue[index] = false;
+			}
+			else if(operation == 3) // Occasionally out of initial priority range
+				readyQueueSetPriority(rq, index, randomRange(&rs, 0, step % 1000 == 0 ? 1 << 20 : 30) - 5);
+			
+			// Top should be same as linear search, and positions should point back to indices
+			int best = -1, size = 0;
+			for(int i=0; i<processNum; i++) if(inQueue[i]){
+				size++;
+				if(best == -1 || tableComparisonGT(table, i, best, criterias[c])) best = i;
+				if(rq->heap[rq->position[i]] != i) same = false;
+			}
+			if(size != rq->size || readyQueueTop(rq) != best) same = false;
+		}
+		free(inQueue);
+		deleteReadyQueue(rq); deleteProcessTable(table);
+	}
+	printf("Indexed ready queue: %s\n", testVerdict(same, "Mismatch with brute force"));
+	free(processes);
+}
+
+// Black height of red-black subtree, or -1 if order, links or colors are broken
+int fairQueueBlackHeight(FairQueue *fq, int x, int parent){
+	if(x == -1) return 0;
+	if(fq->parent[x] != parent || (fq->red[x] && fq->red[parent])) return -1;
+	if((fq->left[x] != -1 && !fairQueueLess(fq, fq->left[x], x)) || (fq->right[x] != -1 && !fairQueueLess(fq, x, fq->right[x]))) return -1;
+	int leftHeight = fairQueueBlackHeight(fq, fq->left[x], x), rightHeight = fairQueueBlackHeight(fq, fq->right[x], x);
+	if(leftHeight == -1 || leftHeight != rightHeight) return -1;
+	return leftHeight + (fq->red[x] ? 0 : 1);
+}
+
+// Testing fair run queue against brute force search, and red-black tree invariants after every operation
+void FairQueueFunctionalityTest(){
+	RandomStream rs; seedRandomStream(&rs, 12345, 0);
+	const int processNum = 500;
+	Process *processes = (Process*)countedMalloc(sizeof(Process) * processNum);
+	for(int i=0; i<processNum; i++) processes[i] = createRandomProcess(&rs, 50, 0, 0, 1000, 0, 39), processes[i].givenPriority -= 20;
+	ProcessTable *table = newProcessTable(processes, processNum);
+	FairQueue *fq = newFairQueue(16, table, 24, 3, 4); // Grows while pushing
+	bool *inQueue = (bool*)countedCalloc(processNum, sizeof(bool)), same = true;
+	long long totalWeight = 0, lastMin = 0;
+	for(int step=0; step<200000; step++){
+		int index = randomRange(&rs, 0, processNum - 1);
+		if(randomRange(&rs, 0, 2) > 0 && !inQueue[index]){
+			fairQueueEnqueue(fq, index, (FairEnqueueKind)randomRange(&rs, 0, 2));
+			inQueue[index] = true, totalWeight += fairWeightOf(table, index);
+		}
+		else if(fq->size > 0){
+			int best = -1;
+			for(int i=0; i<processNum; i++) if(inQueue[i] && (best == -1 || fairQueueLess(fq, i, best))) best = i;
+			int popped = fairQueuePop(fq);
+			if(popped != best || fq->minVruntime < lastMin) same = false;
+			fairQueueCharge(fq, popped, min2(table->CPUburst[popped], fairQueueSlice(fq, popped)));
+			inQueue[popped] = false, totalWeight -= fairWeightOf(table, popped), lastMin = fq->minVruntime;
+		}
+		int size = 0;
+		for(int i=0; i<processNum; i++) size += inQueue[i];
+		if(size != fq->size || totalWeight != fq->totalWeight || (fq->root != -1 && fq->red[fq->root]) ||
+			fairQueueBlackHeight(fq, fq->root, -1) == -1) same = false;
+	}
+	printf("Fair run queue: %s\n", testVerdict(same, "Mismatch with brute force"));
+	free(inQueue); free(processes);
+	deleteFairQueue(fq); deleteProcessTable(table);
+}
+
+// Testing work stealing pool: every task should run exactly once, whichever worker runs it
+void TaskPoolTestTask(void *shared, int task){
+	volatile double spin = 0;
+	for(int i=0; i<(task % 7) * 1000; i++) spin += i; // Uneven tasks, so idle workers steal
+	__atomic_add_fetch((int*)shared + task, 1, __ATOMIC_RELAXED);
+}
+void TaskPoolFunctionalityTest(){
+	const int taskNum = 20000, workerNums[3] = {1, 4, 64};
+	int *ranCount = (int*)countedMalloc(sizeof(int) * taskNum);
+	for(int w=0; w<3; w++){
+		memset(ranCount, 0, sizeof(int) * taskNum);
+		int stolen = runTaskPool(TaskPoolTestTask, ranCount, taskNum, workerNums[w]);
+		bool same = true;
+		for(int t=0; t<taskNum; t++) if(ranCount[t] != 1) same = false;
+		printf("Task pool with %d workers: %s, %d tasks stolen\n", workerNums[w], testVerdict(same, "Mismatch"), stolen);
+	}
+	free(ranCount);
+}
+
+// Testing timeline export by reading binary format back
+void TimelineExportFunctionalityTest(){
+	RandomStream rs; seedRandomStream(&rs, 12345, 0);
+	const int processNum = 300;
+	Process *processes = (Process*)countedMalloc(sizeof(Process) * processNum);
+	for(int i=0; i<processNum; i++) processes[i] = createRandomProcess(&rs, 300, 0, 0, i * 100, 1, 5);
+	ScheduleContext context = newScheduleContext(7, 1, 12345, 1, VerbosityQuiet, stdout);
+	Timeline *timeline = ScheduleGeneral(processes, processNum, false, criteria_RR, 2, &context, "Export test");
+	char *buffer = NULL; size_t size = 0;
+	FILE *memory = open_memstream(&buffer, &size);
+	const char *titles[2] = {"Export test", "Export test again"};
+	for(int r=0; r<2; r++) exportTimeline(memory, TimelineFormatBinary, &timeline, 1, timeline->table, timeline->finishedOrder, processNum, titles[r]);
+	fclose(memory);
+	Timeline *imported[1];
+	bool same = true;
+	size_t position = 0;
+	for(int r=0; r<2 && same; r++){ // Records following each other
+		char title[32]; size_t consumed = 0;
+		same = (importTimelineBinary((unsigned char*)buffer + position, size - position, imported, 1, title, sizeof(title), &consumed) == 1);
+		if(!same) break;
+		same = (strcmp(title, titles[r]) == 0 && imported[0]->timelinesize == timeline->timelinesize);
+		for(int i=0; same && i<timeline->timelinesize; i++)
+			same = (imported[0]->usedProcessesPID[i] == timeline->usedProcessesPID[i] && 
+				imported[0]->interval[i][0] == timeline->interval[i][0] && imported[0]->interval[i][1] == timeline->interval[i][1]);
+		deleteTimeline(imported[0]);
+		position += consumed;
+	}
+	same = same && (position == size);
+	printf("Binary timeline (2 records of %d segments in %d bytes): %s\n", timeline->timelinesize, (int)size, testVerdict(same, "Mismatch"));
+	free(buffer); free(processes);
+	deleteTimeline(timeline);
+}
+
+// Whether two timelines have same segments and statistics
+bool sameTimelines(Timeline *a, Timeline *b){
+	if(a->timelinesize != b->timelinesize || a->timestamp != b->timestamp || a->stats.contextSwitches != b->stats.contextSwitches ||
+		a->stats.turnaround.sum != b->stats.turnaround.sum || a->stats.waiting.sum != b->stats.waiting.sum) return false;
+	for(int i=0; i<a->timelinesize; i++)
+		if(a->usedProcessesPID[i] != b->usedProcessesPID[i] || a->interval[i][0] != b->interval[i][0] || a->interval[i][1] != b->interval[i][1])
+			return false;
+	return true;
+}
+
+// Testing event driven ticking of aging against 1-unit jobs, with context switching cost and on single core SMP
+// with migration cost too. Every run should make exactly same segments.
+void EventDrivenTickingFunctionalityTest(){
+	const int replications = 600;
+	bool same = true, sameSMP = true;
+	bool eventDriven = globalEventDrivenTicking;
+	for(int r=0; r<replications; r++){
+		int cost = r % 4;
+		Process *processes = randomizeProcesses(WorkloadUniform, 12345, r, 25, 20, 40, 1, 1);
+		mergeSort(processes, 0, 25, criteria_FCFS);
+		ProcessTable *workload = newProcessTable(processes, 25);
+		Timeline *timelines[2]; SMPTimeline *smps[2];
+		for(int ticking=0; ticking<2; ticking++){
+			globalEventDrivenTicking = !ticking;
+			ScheduleContext context = newScheduleContext(5, 2, 12345, r, VerbosityQuiet, stdout);
+			timelines[ticking] = ScheduleShared(workload, true, criteria_AGING, cost, &context, "Aging");
+			ScheduleContext SMPContext = newScheduleContext(5, 2, 12345, r, VerbosityQuiet, stdout);
+			SMPContext.migrationCost = r % 3;
+			smps[ticking] = ScheduleSharedSMP(workload, true, criteria_AGING, cost, &SMPContext, "Aging");
+		}
+		same = same && sameTimelines(timelines[0], timelines[1]);
+		sameSMP = sameSMP && sameTimelines(smps[0]->lanes[0], smps[1]->lanes[0]);
+		for(int ticking=0; ticking<2; ticking++) deleteTimeline(timelines[ticking]), deleteSMPTimeline(smps[ticking]);
+		deleteProcessTable(workload);
+		free(processes);
+	}
+	globalEventDrivenTicking = eventDriven;
+	printf("Event driven aging same as 1-unit ticking: %s\n", testVerdict(same, "Mismatch"));
+	printf("Event driven aging same as 1-unit ticking on single core SMP: %s\n", testVerdict(sameSMP, "Mismatch"));
+}
+
+// Measuring simulated events(doJobFor calls) per second in tick based modes, where every time unit is dispatched.
+// doJobFor alone is measured first with runs of 10 ticks per process, then whole scheduling. Best of 5 trials is taken.
+void DispatchBenchmark(){
+	const int processNum = 200000;
+	RandomStream rs; seedRandomStream(&rs, 12345, 0);
+	Process *processes = (Process*)countedMalloc(sizeof(Process) * processNum);
+	for(int i=0, arrival=0; i<processNum; i++){
+		arrival += randomRange(&rs, 0, 20);
+		processes[i] = createProcess(randomRange(&rs, 1, 30), 0, arrival, randomRange(&rs, 1, 5));
+	}
+	struct {const char *title; ProcessComparisonCriteria criteria; int quantum;} runs[] = {
+		{"RoundRobin(quantum 1)", criteria_RR, 1}, {"CustomizedAging-preemptive(ticking)", criteria_AGING, 1}
+	};
+	for(int cost=0; cost<2; cost++){
+		double elapsed = inf;
+		long long events = 0;
+		for(int trial=0; trial<5; trial++){
+			ScheduleContext context = newScheduleContext(1, 1, 12345, 1, VerbosityQuiet, stdout);
+			ProcessTable *table = newProcessTable(processes, 1000);
+			table->refreshesAgingKeys = false;
+			for(int i=0; i<1000; i++) table->CPUburstleft[i] = inf;
+			Timeline *timeline = newTimeline(1000, cost, &context);
+			timeline->table = table;
+			struct timespec begin; clock_gettime(CLOCK_MONOTONIC, &begin);
+			for(int round=0; round<1000; round++) for(int i=0; i<1000; i++) for(int tick=0; tick<10; tick++) doJobFor(timeline, i, 1);
+			elapsed = fmin(elapsed, elapsedSeconds(&begin));
+			events = timeline->stats.dispatches;
+			deleteTimeline(timeline); deleteProcessTable(table);
+		}
+		printf("doJobFor only, context switching cost %d: %lld events in %.3fs, %.2fM events/s\n", cost,
+			events, elapsed, events / elapsed * 1e-6);
+	}
+	bool eventDriven = globalEventDrivenTicking;
+	globalEventDrivenTicking = false;
+	for(int r=0; r<2; r++) for(int cost=0; cost<2; cost++){
+		double elapsed = inf;
+		long long events = 0;
+		for(int trial=0; trial<5; trial++){
+			ScheduleContext context = newScheduleContext(runs[r].quantum, 1, 12345, 1, VerbosityQuiet, stdout);
+			Process *copied = deepCopyProcesses(processes, processNum);
+			struct timespec begin; clock_gettime(CLOCK_MONOTONIC, &begin);
+			Timeline *timeline = ScheduleGeneral(copied, processNum, true, runs[r].criteria, cost, &context, runs[r].title);
+			elapsed = fmin(elapsed, elapsedSeconds(&begin));
+			events = timeline->stats.dispatches;
+			deleteTimeline(timeline); free(copied);
+		}
+		printf("%s, context switching cost %d: %lld events in %.3fs, %.2fM events/s\n", runs[r].title, cost,
+			events, elapsed, events / elapsed * 1e-6);
+	}
+	globalEventDrivenTicking = eventDriven;
+	free(processes);
+}
+
+// Testing streaming statistics against two pass calculation over sorted values
+void RunningMetricFunctionalityTest(){
+	RandomStream rs; seedRandomStream(&rs, 12345, 0);
+	const int valueNum = 100000;
+	int *values = (int*)countedMalloc(sizeof(int) * valueNum);
+	RunningMetric *m = (RunningMetric*)countedMalloc(sizeof(RunningMetric)), *half = (RunningMetric*)countedMalloc(sizeof(RunningMetric));
+	initRunningMetric(m); initRunningMetric(half);
+	double sum = 0;
+	for(int i=0; i<valueNum; i++){
+		values[i] = randomRange(&rs, 0, 1 << randomRange(&rs, 0, 24));
+		addRunningMetric(i < valueNum / 2 ? m : half, values[i]);
+		sum += values[i];
+	} mergeRunningMetric(m, half);
+	double mean = sum / valueNum, squares = 0;
+	for(int i=0; i<valueNum; i++) squares += (values[i] - mean) * (values[i] - mean);
+	bool same = (m->count == valueNum && fabs(m->mean - mean) < 1e-6 * mean && 
+		fabs(runningMetricStddev(m) - sqrt(squares / valueNum)) < 1e-6 * sqrt(squares / valueNum));
+	
+	// Percentiles should be within relative error of bucket width
+	Process *sorted = (Process*)countedMalloc(sizeof(Process) * valueNum);
+	for(int i=0; i<valueNum; i++) sorted[i].arrivalTime = values[i], sorted[i].PID = i;
+	mergeSort(sorted, 0, valueNum, criteria_FCFS);
+	double quantiles[4] = {0.5, 0.95, 0.99, 1.0};
+	for(int i=0; i<4; i++){
+		int exact = sorted[(int)ceil(quantiles[i] * valueNum) - 1].arrivalTime, approximated = runningMetricPercentile(m, quantiles[i]);
+		if(abs(approximated - exact) > exact / metricSubBuckets + 1) same = false;
+		printf("q=%.2f: exact %d, approximated %d\n", quantiles[i], exact, approximated);
+	}
+	if(runningMetricPercentile(m, 0.0) != sorted[0].arrivalTime || runningMetricPercentile(m, 1.0) != sorted[valueNum-1].arrivalTime ||
+		runningMetricPercentile(m, -1.0) != sorted[0].arrivalTime || runningMetricPercentile(m, 2.0) != sorted[valueNum-1].arrivalTime) same = false;
+	printf("Running metric same as two pass calculation: %s\n", testVerdict(same, "Mismatch"));
+	free(values); free(sorted); free(m); free(half);
+}
+
+// Testing trace reader by scheduling same records from array, text trace and memory mapped binary trace
+void TraceReaderFunctionalityTest(){
+	RandomStream rs; seedRandomStream(&rs, 12345, 0);
+	const int processNum = 2000;
+	char textPath[] = "/tmp/kuos_trace_XXXXXX", binaryPath[] = "/tmp/kuos_trace_XXXXXX";
+	FILE *text = fdopen(mkstemp(textPath), "w"), *binary = fdopen(mkstemp(binaryPath), "wb");
+	Process *processes = (Process*)countedMalloc(sizeof(Process) * processNum);
+	fprintf(text, "# arrival cpu io priority\n");
+	fwrite("KUTR", 1, 4, binary);
+	for(int i=0, arrival=0; i<processNum; i++){
+		arrival += randomRange(&rs, 0, 10);
+		int record[4] = {arrival, (int)randomRange(&rs, 1, 30), (int)randomRange(&rs, 0, 3), (int)randomRange(&rs, 1, 5)};
+		processes[i] = createProcess(record[1], record[2], record[0], record[3]);
+		fprintf(text, "%d %d %d %d\n", record[0], record[1], record[2], record[3]);
+		for(int j=0; j<4; j++) for(int b=0; b<4; b++) fputc(((unsigned int)record[j] >> (8*b)) & 0xFF, binary);
+	}
+	fclose(text); fclose(binary);
+	
+	bool same = true;
+	for(int criteria = criteria_FCFS; criteria < criteria_COUNT; criteria++){
+		ScheduleContext context = newScheduleContext(5, 1, 12345, 1, VerbosityQuiet, stdout);
+		Process *copied = deepCopyProcesses(processes, processNum);
+		Timeline *expected = ScheduleGeneral(copied, processNum, true, (ProcessComparisonCriteria)criteria, 1, &context, "Array");
+		for(int mapped=0; mapped<2; mapped++){
+			ScheduleContext traceContext = newScheduleContext(5, 1, 12345, 1, VerbosityQuiet, stdout);
+			TraceReader *reader = openTraceReader(mapped ? binaryPath : textPath, mapped);
+			Timeline *streamed = ScheduleTrace(reader, true, (ProcessComparisonCriteria)criteria, 1, &traceContext, "Trace");
+			if(streamed->stats.finishedNum != processNum || streamed->stats.turnaround.sum != expected->stats.turnaround.sum ||
+				streamed->stats.waiting.sum != expected->stats.waiting.sum || streamed->timestamp != expected->timestamp) same = false;
+			closeTraceReader(reader);
+			deleteTimeline(streamed);
+		}
+		deleteTimeline(expected); free(copied);
+	}
+	printf("Trace scheduling same as array scheduling: %s\n", testVerdict(same, "Mismatch"));
+	remove(textPath); remove(binaryPath);
+	free(processes);
+}
+
+// Run every functionality test. Return number of failed checks.
+int functionalityTests(){
+	globalTestFailures = 0;
+	DequeFunctionalityTest1();
+	DequeFunctionalityTest2();
+	SelectionSortFunctionalityTest();
+	MergeSortFunctionalityTest();
+	WorkloadGeneratorFunctionalityTest();
+	ArgminKernelFunctionalityTest();
+	IndexedHeapFunctionalityTest();
+	FairQueueFunctionalityTest();
+	TaskPoolFunctionalityTest();
+	TimelineExportFunctionalityTest();
+	TraceReaderFunctionalityTest();
+	EventDrivenTickingFunctionalityTest();
+	RunningMetricFunctionalityTest();
+	printf("Functionality tests: %d failed checks\n", globalTestFailures);
+	return globalTestFailures;
+}
+
+// Policies which schedulingTests, trace evaluation, benchmark and sweep run. Built-in ones come first, and 
+// registerSchedulePolicy appends more. Policy with multi-core title is also run on multiple cores by schedulingTests
+// if multiple cores are configured; Only criterias which ScheduleSMP supports can have it.
+struct PolicySpec__{
+	const char *title;
+	ProcessComparisonCriteria criteria;
+	bool preemptive;
+	const char *multiCoreTitle; // NULL if not run on multiple cores
+}; typedef struct PolicySpec__ PolicySpec;
+#define maxSchedulePolicyNum 32
+#define builtinSchedulePolicies \
+	{"FCFS", criteria_FCFS, false, "FCFS-SMP"}, \
+	{"SJF", criteria_SJF, false, "SJF-SMP"}, \
+	{"SJF-preemptive", criteria_SJF, true, "SJF-preemptive-SMP"}, \
+	{"Priority", criteria_P, false, NULL}, \
+	{"Priority-preemptive", criteria_P, true, "Priority-preemptive-SMP"}, \
+	{"CustomizedAging-preemptive", criteria_AGING, true, "CustomizedAging-preemptive-SMP"}, \
+	{"RoundRobin", criteria_RR, false, "RoundRobin-SMP"}, \
+	{"DynamicPriority-preemptive", criteria_PDy, true, NULL}, \
+	{"MultilevelFeedbackQueue", criteria_MLFQ, true, NULL}
+PolicySpec schedulePolicies[maxSchedulePolicyNum] = {builtinSchedulePolicies};
+static int schedulePolicyNum = sizeof((PolicySpec[]){builtinSchedulePolicies}) / sizeof(PolicySpec);
+
+// Add new single core policy. If loop is given, it becomes scheduling loop of given criteria and preemptiveness 
+// (see defineScheduleLoop). New criteria should be added to ProcessComparisonCriteria with its comparison and 
+// ready queue key first. Should be called before any evaluation starts. Return false if it can't be registered.
+bool registerSchedulePolicy(const char *title, ProcessComparisonCriteria criteria, bool preemptive, ScheduleLoop loop){
+	if(schedulePolicyNum == maxSchedulePolicyNum || (int)criteria < 0 || criteria >= criteria_COUNT){
+		printf("[Warning] Too many policies or invalid criteria(%d), %s is not registered.\n", (int)criteria, title);
+		return false;
+	}
+	if(loop != NULL && !registerScheduleLoop(criteria, preemptive, loop)) return false;
+	schedulePolicies[schedulePolicyNum].title = title;
+	schedulePolicies[schedulePolicyNum].criteria = criteria, schedulePolicies[schedulePolicyNum].preemptive = preemptive;
+	schedulePolicies[schedulePolicyNum].multiCoreTitle = NULL;
+	schedulePolicyNum++;
+	return true;
+}
+
+// Evaluation. If parallel is true, each policy runs on its own thread and outputs are merged in fixed order.
+// Workload is drawn from stream 0 of given seed, and policy i uses stream i+1 for its own randomness.
+void schedulingTests(int processNum, int burstScale, int arrivalScale, int contextSwitchingCost, int IOcount, 
+		Verbosity verbosity, bool parallel, unsigned long long seed){
+	
+	// Parameter evaluation
+	if(burstScale <= 0 || processNum <= 0 || arrivalScale < 0){
+		printf("[Error] Nonpositive process num(%d) or scalars(%d, %d) given - evaluation will be terminated.\n",
+			processNum, burstScale, arrivalScale);
+		exit(-1);
+	}
+
+	// Process randomizing
+	Process *processes = randomizeProcesses(globalWorkloadKind, seed, 0, processNum, burstScale, arrivalScale, IOcount, 
+		max2(1, (int)sysconf(_SC_NPROCESSORS_ONLN)));
+	if(verbosity >= VerbosityNormal){
+		OutputWriter *writer = newOutputWriter(stdout);
+		writerPrintf(writer, "Initial processes (random seed = %llu):\n", seed);
+		writeMultiProcesses(writer, processes, processNum, ProcessRepresentMinimal);
+		writerPutRepeat(writer, '-', 60); writerPutChar(writer, '\n');
+		deleteOutputWriter(writer);
+	}
+	
+	// Workload table shared by all runs; Processes are sorted by arrival once.
+	mergeSort(processes, 0, processNum, criteria_FCFS);
+	ProcessTable *workload = newProcessTable(processes, processNum);
+	free(processes);
+	
+	// Policies: Every registered one, and then multi-core ones if multiple cores are configured
+	PolicyRun runs[2 * maxSchedulePolicyNum];
+	int runNum = 0;
+	for(int i=0; i<schedulePolicyNum; i++){
+		const PolicySpec *policy = schedulePolicies + i;
+		runs[runNum++] = (PolicyRun){.title = policy->title, .criteria = policy->criteria, .preemptive = policy->preemptive, .multiCore = false};
+	}
+	for(int i=0; i<schedulePolicyNum && globalCoreNum > 1; i++){
+		const PolicySpec *policy = schedulePolicies + i;
+		if(policy->multiCoreTitle == NULL) continue;
+		runs[runNum++] = (PolicyRun){.title = policy->multiCoreTitle, .criteria = policy->criteria, .preemptive = policy->preemptive, .multiCore = true};
+	}
+	for(int i=0; i<runNum; i++){
+		runs[i].workload = workload, runs[i].contextswitchingcost = contextSwitchingCost;
+		runs[i].outputBuffer = NULL, runs[i].outputSize = 0;
+		runs[i].context = newScheduleContext(globalRRQuantumTime, globalIODeviceNum, seed, i + 1, verbosity, 
+			parallel ? open_memstream(&runs[i].outputBuffer, &runs[i].outputSize) : stdout);
+		runs[i].context.coreNum = globalCoreNum, runs[i].context.migrationCost = globalMigrationCost;
+		runs[i].context.balancing = globalLoadBalancing;
+		applyGlobalPolicyConfig(&runs[i].context);
+		runs[i].context.format = globalTimelineFormat;
+	}
+	
+	// Sequential
+	exportTimelinesBegin(stdout, globalTimelineFormat);
+	if(!parallel){
+		for(int i=0; i<runNum; i++){
+			if(i > 0) exportTimelinesBetween(stdout, globalTimelineFormat);
+			runPolicy(runs + i);
+		}
+		exportTimelinesEnd(stdout, globalTimelineFormat);
+		deleteProcessTable(workload);
+		return;
+	}
+	
+	// Parallel: If thread can't be created then run it on this thread.
+	pthread_t threads[2 * maxSchedulePolicyNum];
+	bool threadCreated[2 * maxSchedulePolicyNum];
+	for(int i=0; i<runNum; i++){
+		threadCreated[i] = (pthread_create(threads + i, NULL, runPolicy, runs + i) == 0);
+		if(!threadCreated[i]) runPolicy(runs + i);
+	}
+	for(int i=0; i<runNum; i++){
+		if(threadCreated[i]) pthread_join(threads[i], NULL);
+		fclose(runs[i].context.output);
+		if(i > 0) exportTimelinesBetween(stdout, globalTimelineFormat);
+		fwrite(runs[i].outputBuffer, 1, runs[i].outputSize, stdout);
+		free(runs[i].outputBuffer);
+	}
+	exportTimelinesEnd(stdout, globalTimelineFormat);
+	deleteProcessTable(workload);
+}
+
+// Evaluation on trace file. Each policy reads trace again from the beginning, so memory doesn't depend on trace length.
+// Policy i uses stream i+1 of given seed for its own randomness, same as schedulingTests.
+void traceTests(const char *tracePath, bool memoryMapped, int contextSwitchingCost, Verbosity verbosity, unsigned long long seed){
+	for(int i=0; i<schedulePolicyNum; i++){
+		const PolicySpec *policy = schedulePolicies + i;
+		TraceReader *reader = openTraceReader(tracePath, memoryMapped);
+		if(reader == NULL){
+			printf("[Error] Can't open trace %s\n", tracePath);
+			exit(-1);
+		}
+		ScheduleContext context = newScheduleContext(globalRRQuantumTime, globalIODeviceNum, seed, i + 1, verbosity, stdout);
+		applyGlobalPolicyConfig(&context);
+		Timeline *scheduled = ScheduleTrace(reader, policy->preemptive, policy->criteria, contextSwitchingCost, &context, policy->title);
+		TraceSummary(scheduled, policy->title);
+		deleteTimeline(scheduled);
+		closeTraceReader(reader);
+	}
+}
+
+// Non-interactive benchmark. Every registered policy is run on every combination of parameters below, with
+// processes randomized and shared as schedulingTests does, and one CSV row per run is written to out.
+// Scheduling and Gantt chart(normal verbosity, written to /dev/null) are timed separately.
+// Peak RSS is of whole program so far; parameters are swept from small to large so it mostly reflects current size.
+// Allocations and allocated bytes of each run are written only if compiled with -DuseAllocCounters.
+void benchmarkTests(FILE *out, unsigned long long seed){
+	const int processNums[] = {1000, 10000, 100000}, burstScales[] = {10, 100}, arrivalScales[] = {1, 10}, costs[] = {0, 2};
+	FILE *discarded = fopen("/dev/null", "w");
+	if(discarded == NULL){
+		printf("[Error] Can't open /dev/null for benchmark\n");
+		exit(-1);
+	}
+	fprintf(out, "policy,workload,processNum,burstScale,arrivalScale,contextSwitchingCost,scheduleSeconds,chartSeconds,"
+		"events,eventsPerSecond,peakRSSKiB");
+#ifdef useAllocCounters
+	fprintf(out, ",allocations,allocatedBytes");
+#endif
+	fprintf(out, "\n");
+	for(int n=0; n<3; n++) for(int b=0; b<2; b++) for(int a=0; a<2; a++) for(int c=0; c<2; c++){
+		int processNum = processNums[n];
+		Process *processes = randomizeProcesses(globalWorkloadKind, seed, 0, processNum, burstScales[b], arrivalScales[a], 0, 
+			max2(1, (int)sysconf(_SC_NPROCESSORS_ONLN)));
+		mergeSort(processes, 0, processNum, criteria_FCFS);
+		ProcessTable *workload = newProcessTable(processes, processNum);
+		free(processes);
+		for(int i=0; i<schedulePolicyNum; i++){
+			const PolicySpec *policy = schedulePolicies + i;
+			ScheduleContext context = newScheduleContext(globalRRQuantumTime, 1, seed, i + 1, VerbosityQuiet, discarded);
+			applyGlobalPolicyConfig(&context);
+#ifdef useAllocCounters
+			long long allocations = globalAllocationCount, allocatedBytes = globalAllocatedBytes;
+#endif
+			struct timespec begin; clock_gettime(CLOCK_MONOTONIC, &begin);
+			Timeline *scheduled = ScheduleShared(workload, policy->preemptive, policy->criteria, costs[c], &context, policy->title);
+			double scheduleSeconds = elapsedSeconds(&begin);
+			context.verbosity = VerbosityNormal;
+			clock_gettime(CLOCK_MONOTONIC, &begin);
+			GanttChart(scheduled, policy->title);
+			double chartSeconds = elapsedSeconds(&begin);
+			fprintf(out, "%s,%s,%d,%d,%d,%d,%.6f,%.6f,%lld,%.0f,%ld", policy->title, 
+				WorkloadKindNames[globalWorkloadKind], processNum, burstScales[b], 
+				arrivalScales[a], costs[c], scheduleSeconds, chartSeconds, scheduled->stats.dispatches, 
+				scheduled->stats.dispatches / fmax(scheduleSeconds, 1e-9), peakRSS());
+#ifdef useAllocCounters
+			fprintf(out, ",%lld,%lld", globalAllocationCount - allocations, globalAllocatedBytes - allocatedBytes);
+#endif
+			fprintf(out, "\n");
+			fflush(out);
+			deleteTimeline(scheduled);
+		}
+		deleteProcessTable(workload);
+	}
+	fclose(discarded);
+}
+
+// Monte Carlo sweep. Every registered policy is run on many independent workloads of sweepProcessNum processes for
+// every combination of parameters below, and mean turnaround and waiting times of runs are reduced into means and
+// 95% confidence intervals(normal approximation) over replications. One CSV row per combination and policy.
+// Replications are tasks of work stealing pool. Replication r of combination k is task t = k * replications + r,
+// whose workload is drawn from stream t * (schedulePolicyNum + 1) of given seed, and policy i uses next i+1 streams,
+// so results don't depend on thread count.
+#define sweepProcessNum 100
+struct SweepShared__{
+	int replications;
+	int (*combinations)[4]; // Burst scale, arrival scale, context switching cost, RR quantum time
+	unsigned long long seed;
+	FILE *discarded;
+	double *turnaround, *waiting; // Mean of each run, at (task * schedulePolicyNum + policy)
+}; typedef struct SweepShared__ SweepShared;
+
+// Single replication as pool task
+void sweepReplication(void *arg, int task){
+	SweepShared *shared = (SweepShared*)arg;
+	int *combination = shared->combinations[task / shared->replications];
+	unsigned long long stream = (unsigned long long)task * (schedulePolicyNum + 1);
+	Process *processes = randomizeProcesses(globalWorkloadKind, shared->seed, stream, sweepProcessNum, combination[0], combination[1], 0, 1);
+	for(int i=0; i<sweepProcessNum; i++) processes[i].PID = i + 1; // Global counter is shared with other workers, so order of PIDs would vary
+	mergeSort(processes, 0, sweepProcessNum, criteria_FCFS);
+	ProcessTable *workload = newProcessTable(processes, sweepProcessNum);
+	free(processes);
+	for(int i=0; i<schedulePolicyNum; i++){
+		const PolicySpec *policy = schedulePolicies + i;
+		ScheduleContext context = newScheduleContext(combination[3], 1, shared->seed, stream + i + 1, VerbosityQuiet, shared->discarded);
+		applyGlobalPolicyConfig(&context);
+		Timeline *scheduled = ScheduleShared(workload, policy->preemptive, policy->criteria, combination[2], &context, policy->title);
+		shared->turnaround[task * schedulePolicyNum + i] = scheduled->stats.turnaround.mean;
+		shared->waiting[task * schedulePolicyNum + i] = scheduled->stats.waiting.mean;
+		deleteTimeline(scheduled);
+	}
+	deleteProcessTable(workload);
+}
+
+// Mean and half width of 95% confidence interval of values[i * stride] for i in [0, n)
+void confidenceInterval(const double *values, int n, int stride, double *mean, double *halfWidth){
+	double sum = 0, squares = 0;
+	for(int i=0; i<n; i++) sum += values[(long long)i * stride];
+	*mean = sum / n;
+	for(int i=0; i<n; i++) squares += (values[(long long)i * stride] - *mean) * (values[(long long)i * stride] - *mean);
+	*halfWidth = n > 1 ? 1.96 * sqrt(squares / (n - 1) / n) : 0.0;
+}
+
+// Run sweep with given replications per combination on threadNum workers, and write CSV to out
+void sweepTests(FILE *out, int replications, unsigned long long seed, int threadNum){
+	const int burstScales[] = {10, 50}, arrivalScales[] = {1, 5}, costs[] = {0, 2}, quantums[] = {2, 10};
+	int combinations[16][4], combinationNum = 0;
+	for(int b=0; b<2; b++) for(int a=0; a<2; a++) for(int c=0; c<2; c++) for(int q=0; q<2; q++){
+		combinations[combinationNum][0] = burstScales[b], combinations[combinationNum][1] = arrivalScales[a];
+		combinations[combinationNum][2] = costs[c], combinations[combinationNum][3] = quantums[q];
+		combinationNum++;
+	}
+	SweepShared shared = {.replications = max2(1, replications), .combinations = combinations, .seed = seed, 
+		.discarded = fopen("/dev/null", "w"), .turnaround = NULL, .waiting = NULL};
+	if(shared.discarded == NULL){
+		printf("[Error] Can't open /dev/null for sweep\n");
+		exit(-1);
+	}
+	int taskNum = combinationNum * shared.replications;
+	shared.turnaround = (double*)countedMalloc(sizeof(double) * taskNum * schedulePolicyNum);
+	shared.waiting = (double*)countedMalloc(sizeof(double) * taskNum * schedulePolicyNum);
+	runTaskPool(sweepReplication, &shared, taskNum, threadNum);
+	
+	// Reduction in fixed order
+	fprintf(out, "workload,burstScale,arrivalScale,contextSwitchingCost,RRQuantumTime,policy,replications,"
+		"turnaroundMean,turnaroundCI95,waitingMean,waitingCI95\n");
+	for(int k=0; k<combinationNum; k++) for(int i=0; i<schedulePolicyNum; i++){
+		long long first = (long long)k * shared.replications * schedulePolicyNum + i;
+		double turnaroundMean, turnaroundHalf, waitingMean, waitingHalf;
+		confidenceInterval(shared.turnaround + first, shared.replications, schedulePolicyNum, &turnaroundMean, &turnaroundHalf);
+		confidenceInterval(shared.waiting + first, shared.replications, schedulePolicyNum, &waitingMean, &waitingHalf);
+		fprintf(out, "%s,%d,%d,%d,%d,%s,%d,%.4f,%.4f,%.4f,%.4f\n", WorkloadKindNames[globalWorkloadKind], combinations[k][0], 
+			combinations[k][1], combinations[k][2], combinations[k][3], schedulePolicies[i].title, shared.replications, turnaroundMean, turnaroundHalf, waitingMean, waitingHalf);
+	}
+	free(shared.turnaround); free(shared.waiting);
+	fclose(shared.discarded);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Main function
+
+// Prompt is not shown in quiet verbosity, so exported timelines are not mixed with it.
+void prompt(const char *message){
+	if(globalVerbosity >= VerbositySummary) fputs(message, stdout);
+}
+
+// Arguments which take values, with number of values following them
+const struct {const char *name; int valueNum;} ArgumentValueNums[] = {
+	{"--format", 1}, {"--verbosity", 1}, {"--trace", 1}, {"--cfs", 3}, {"--aging", 2}, {"--workload", 1},
+	{"--benchmark-out", 1}, {"--sweep-out", 1}, {"--replications", 1}
+};
+
+// Number of values following given argument; 0 for flags without values and seed
+int argumentValueNum(const char *argument){
+	for(int i=0; i<(int)(sizeof(ArgumentValueNums) / sizeof(ArgumentValueNums[0])); i++)
+		if(strcmp(argument, ArgumentValueNums[i].name) == 0) return ArgumentValueNums[i].valueNum;
+	return 0;
+}
+
+// Print arguments of main, see comment of main
+void printUsage(const char *program){
+	printf("Usage: %s [seed] [--format text|binary|csv|json] [--verbosity 0-3] [--trace path [--mmap]]\n", program);
+	printf("       [--benchmark [--benchmark-out path]] [--cfs targetLatency minGranularity wakeupGranularity]\n");
+	printf("       [--aging exponential|linear agingFactor] [--sweep [--sweep-out path] [--replications n]]\n");
+	printf("       [--workload uniform|heavy] [--test]\n");
+}
+
+// Arguments: [seed] [--format text|binary|csv|json] [--verbosity 0-3] [--trace path [--mmap]] [--benchmark [--benchmark-out path]]
+//            [--cfs targetLatency minGranularity wakeupGranularity] [--aging exponential|linear agingFactor] [--sweep [--sweep-out path] [--replications n]]
+//            [--workload uniform|heavy] [--test]
+// Current time is used if seed is not given, and seed should be whole decimal number. Unknown argument or missing value
+// of argument prints usage and exits. Verbosity is 0: quiet, 1: summary, 2: normal(default), 3: debug.
+// Format other than text exports timelines only(see Timeline export), so verbosity is forced to be quiet.
+// With trace, processes are read from trace file instead of being randomized (see Trace reader).
+// With benchmark, nothing is asked and CSV is written to benchmark-out path(or standard output); seed is 12345 if not given.
+// Workload is the kind of randomized processes(see randomizeProcesses), uniform if not given; Benchmark and sweep use it too.
+// CFS parameters are in time units, 24, 3 and 4 if not given. Aging is exponential with factor 0.75 if not given.
+// With sweep, nothing is asked and CSV of confidence intervals over n(1000 if not given) replications is written to
+// sweep-out path(or standard output); Seed is 12345 if not given, same as benchmark.
+// With test, every functionality test is run(see functionalityTests), and exit status is nonzero if any check failed.
+int main(int argc, char **argv){
+	
+	//DispatchBenchmark(); // Functionality tests are run by --test
+
+	// Completely fair scheduling is plugged in through registration, same as any policy outside builtin list
+	registerSchedulePolicy("CompletelyFair-preemptive", criteria_CFS, true, NULL);
+
+	unsigned long long seed = (unsigned long long)time(NULL);
+	const char *tracePath = NULL, *benchmarkPath = NULL, *sweepPath = NULL;
+	bool memoryMapped = false, benchmark = false, sweep = false, test = false, seedGiven = false;
+	int replications = 1000;
+	for(int i=1; i<argc; i++){
+		if(i + argumentValueNum(argv[i]) >= argc){
+			printf("[Error] Missing value of %s\n", argv[i]);
+			printUsage(argv[0]);
+			exit(-1);
+		}
+		if(strcmp(argv[i], "--format") == 0){
+			int format = 0;
+			while(format < 4 && strcmp(argv[i+1], TimelineFormatNames[format]) != 0) format++;
+			if(format == 4){
+				printf("[Error] Unknown timeline format '%s'\n", argv[i+1]);
+				exit(-1);
+			} globalTimelineFormat = (TimelineFormat)format, i++;
+		}
+		else if(strcmp(argv[i], "--verbosity") == 0)
+			globalVerbosity = (Verbosity)max2(VerbosityQuiet, min2(VerbosityDebug, atoi(argv[++i])));
+		else if(strcmp(argv[i], "--trace") == 0) tracePath = argv[++i];
+		else if(strcmp(argv[i], "--mmap") == 0) memoryMapped = true;
+		else if(strcmp(argv[i], "--cfs") == 0){
+			globalCFSTargetLatency = atoi(argv[i+1]), globalCFSMinGranularity = atoi(argv[i+2]);
+			globalCFSWakeupGranularity = atoi(argv[i+3]), i += 3;
+			if(globalCFSTargetLatency <= 0 || globalCFSMinGranularity <= 0 || globalCFSWakeupGranularity < 0){
+				printf("[Error] Nonpositive CFS target latency(%d) or minimum granularity(%d), or negative wakeup granularity(%d)\n", 
+					globalCFSTargetLatency, globalCFSMinGranularity, globalCFSWakeupGranularity);
+				exit(-1);
+			}
+		}
+		else if(strcmp(argv[i], "--aging") == 0){
+			if(strcmp(argv[i+1], "linear") != 0 && strcmp(argv[i+1], "exponential") != 0){
+				printf("[Error] Unknown aging formula '%s'\n", argv[i+1]);
+				exit(-1);
+			}
+			AgingFormula formula = (strcmp(argv[i+1], "linear") == 0 ? AgingFormulaLinear : AgingFormulaExponential);
+			globalAgingConfig = newAgingConfig(formula, atof(argv[i+2])), i += 2;
+		}
+		else if(strcmp(argv[i], "--workload") == 0){
+			int kind = 0;
+			while(kind < 2 && strcmp(argv[i+1], WorkloadKindNames[kind]) != 0) kind++;
+			if(kind == 2){
+				printf("[Error] Unknown workload '%s'\n", argv[i+1]);
+				exit(-1);
+			} globalWorkloadKind = (WorkloadKind)kind, i++;
+		}
+		else if(strcmp(argv[i], "--benchmark") == 0) benchmark = true;
+		else if(strcmp(argv[i], "--benchmark-out") == 0) benchmarkPath = argv[++i];
+		else if(strcmp(argv[i], "--sweep") == 0) sweep = true;
+		else if(strcmp(argv[i], "--test") == 0) test = true;
+		else if(strcmp(argv[i], "--sweep-out") == 0) sweepPath = argv[++i];
+		else if(strcmp(argv[i], "--replications") == 0){
+			replications = atoi(argv[++i]);
+			if(replications <= 0){
+				printf("[Error] Nonpositive replications(%d)\n", replications);
+				exit(-1);
+			}
+		}
+		else{
+			char *end;
+			seed = strtoull(argv[i], &end, 10), seedGiven = true;
+			if(argv[i][0] < '0' || argv[i][0] > '9' || *end != '\0'){
+				printf("[Error] Unknown argument '%s'\n", argv[i]);
+				printUsage(argv[0]);
+				exit(-1);
+			}
+		}
+	}
+	if(globalTimelineFormat != TimelineFormatText && tracePath == NULL) globalVerbosity = VerbosityQuiet; // Nothing but exports
+	if(test) return functionalityTests() == 0 ? 0 : -1;
+	if(benchmark){
+		FILE *out = (benchmarkPath == NULL ? stdout : fopen(benchmarkPath, "w"));
+		if(out == NULL){
+			printf("[Error] Can't open benchmark output %s\n", benchmarkPath);
+			exit(-1);
+		}
+		benchmarkTests(out, seedGiven ? seed : 12345);
+		if(out != stdout) fclose(out);
+		return 0;
+	}
+	if(sweep){
+		FILE *out = (sweepPath == NULL ? stdout : fopen(sweepPath, "w"));
+		if(out == NULL){
+			printf("[Error] Can't open sweep output %s\n", sweepPath);
+			exit(-1);
+		}
+		sweepTests(out, replications, seedGiven ? seed : 12345, max2(1, (int)sysconf(_SC_NPROCESSORS_ONLN)));
+		if(out != stdout) fclose(out);
+		return 0;
+	}
+	
+	prompt("Welcome to the Minsung's CPU scheduling world!\n");
+	if(tracePath != NULL){
+		prompt("Please input the context switching cost(non-negative number): ");
+		int contextswitchingcost; if(scanf("%d", &contextswitchingcost) != 1 || contextswitchingcost < 0) exit(-1);
+		prompt("Please input the RR quantum time(positive number): ");
+		if(scanf("%d", &globalRRQuantumTime) != 1 || globalRRQuantumTime <= 0) exit(-1);
+		setRandomSeed(seed);
+		traceTests(tracePath, memoryMapped, contextswitchingcost, globalVerbosity, globalRandomSeed);
+		return 0;
+	}
+	prompt("Please input the number of processes(positive number): ");
 	int processNum; scanf("%d", &processNum); if(processNum <= 0) exit(-1);
-	printf("Please input the burst scale(positive number): ");
+	prompt("Please input the burst scale(positive number): ");
 	int burstScale; scanf("%d", &burstScale); if(burstScale <= 0) exit(-1);
-	printf("Please input the arrival scale(non-negative number): ");
+	prompt("Please input the arrival scale(non-negative number): ");
 	int arrivalScale; scanf("%d", &arrivalScale); if(arrivalScale < 0) exit(-1);
-	printf("Please input the context switching cost(non-negative number): ");
+	prompt("Please input the context switching cost(non-negative number): ");
 	int contextswitchingcost; scanf("%d", &contextswitchingcost); if(contextswitchingcost < 0) exit(-1);
-	printf("Please input the RR quantum time(positive number): ");
+	prompt("Please input the RR quantum time(positive number): ");
 	scanf("%d", &globalRRQuantumTime); if(globalRRQuantumTime <= 0) exit(-1);
-	schedulingTests(processNum, burstScale, arrivalScale, contextswitchingcost, false);
+	prompt("Please input the number of I/O bursts per process and I/O devices(non-negative, positive; 0 1 if omitted): ");
+	int IOcount = 0; 
+	if(scanf("%d %d", &IOcount, &globalIODeviceNum) != 2) IOcount = 0, globalIODeviceNum = 1;
+	if(IOcount < 0 || globalIODeviceNum <= 0) exit(-1);
+	prompt("Please input the number of cores, load balancing(0: global queue, 1: work stealing, 2: affinity) "
+		"and migration cost(1 0 0 if omitted): ");
+	int balancing = 0;
+	if(scanf("%d %d %d", &globalCoreNum, &balancing, &globalMigrationCost) != 3) globalCoreNum = 1, balancing = 0, globalMigrationCost = 0;
+	if(globalCoreNum <= 0 || balancing < 0 || balancing > 2 || globalMigrationCost < 0) exit(-1);
+	globalLoadBalancing = (LoadBalancing)balancing;
+	setRandomSeed(seed);
+	schedulingTests(processNum, burstScale, arrivalScale, contextswitchingcost, IOcount, globalVerbosity, 
+		sysconf(_SC_NPROCESSORS_ONLN) > 1, globalRandomSeed);
 	
 	return 0;
 }